@@ -0,0 +1,185 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Commandlets/InventoryReplayCommandlet.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include "HAL/PlatformTime.h"
+
+#include "Components/InventoryComponent.h"
+#include "Components/InventoryJournal.h"
+#include "Items/EquippableItem.h"
+
+namespace InventoryReplay
+{
+	static constexpr int32 NumOps = (int32)EInventoryJournalOp::Drop + 1;
+
+	static const TCHAR* OpNames[NumOps] = { TEXT("Register"), TEXT("WeightCapacity"), TEXT("Add"), TEXT("Consume"), TEXT("Remove"), TEXT("Equip"), TEXT("Drop") };
+}
+
+UInventoryReplayCommandlet::UInventoryReplayCommandlet()
+{
+	IsClient = false;
+	IsServer = true;
+	IsEditor = false;
+	LogToConsole = true;
+}
+
+int32 UInventoryReplayCommandlet::Main(const FString& Params)
+{
+	FString JournalFilename;
+	if (!FParse::Value(*Params, TEXT("Journal="), JournalFilename))
+	{
+		UE_LOG(LogTemp, Error, TEXT("InventoryReplay: missing -Journal=<path>"));
+		return 1;
+	}
+
+	int32 Iterations = 1;
+	FParse::Value(*Params, TEXT("Iterations="), Iterations);
+	Iterations = FMath::Max(Iterations, 1);
+
+	TArray<FInventoryJournalRecord> Records;
+	TArray<FString> ClassNames;
+	if (!FInventoryJournal::Load(JournalFilename, Records, ClassNames))
+	{
+		UE_LOG(LogTemp, Error, TEXT("InventoryReplay: couldn't load journal %s"), *JournalFilename);
+		return 1;
+	}
+
+	TArray<UClass*> ItemClasses;
+	ItemClasses.SetNumZeroed(ClassNames.Num());
+	for (int32 i = 1; i < ClassNames.Num(); ++i)
+	{
+		ItemClasses[i] = FSoftClassPath(ClassNames[i]).TryLoadClass<UItem>();
+		if (!ItemClasses[i])
+			UE_LOG(LogTemp, Warning, TEXT("InventoryReplay: couldn't load item class %s, its records are skipped"), *ClassNames[i]);
+	}
+
+	UWorld* World = UWorld::CreateWorld(EWorldType::Game, false, TEXT("InventoryReplayWorld"));
+	FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+	WorldContext.SetCurrentWorld(World);
+	World->InitializeActorsForPlay(FURL());
+
+	double OpSeconds[InventoryReplay::NumOps] = {};
+	int64 OpCounts[InventoryReplay::NumOps] = {};
+	int64 NumSkipped = 0;
+
+	for (int32 Iteration = 0; Iteration < Iterations; ++Iteration)
+	{
+		TMap<uint32, UInventoryComponent*> Inventories;
+
+		// The replay's item for each journaled item id.
+		TMap<uint32, UItem*> ReplayItems;
+
+		auto FindOrCreateInventory = [World, &Inventories](const uint32 InventoryId)
+		{
+			if (UInventoryComponent** Found = Inventories.Find(InventoryId))
+				return *Found;
+
+			// The ring may have overwritten the register record, those inventories get the default capacities.
+			AActor* Owner = World->SpawnActor<AActor>();
+			UInventoryComponent* Inventory = NewObject<UInventoryComponent>(Owner);
+			Inventory->RegisterComponent();
+			return Inventories.Add(InventoryId, Inventory);
+		};
+
+		auto FindReplayItem = [&ReplayItems](UInventoryComponent* Inventory, const FInventoryJournalRecord& Record, UClass* ItemClass) -> UItem*
+		{
+			UItem* Item = ReplayItems.FindRef(Record.ItemId);
+			if (Item && Item->OwningInventory == Inventory)
+				return Item;
+
+			// Items whose add the ring overwrote have no replay item, the first stack of the class stands in for them.
+			return ItemClass ? Inventory->FindItemByClass(ItemClass) : nullptr;
+		};
+
+		for (const FInventoryJournalRecord& Record : Records)
+		{
+			if (Record.Op >= InventoryReplay::NumOps)
+				continue;
+
+			const EInventoryJournalOp Op = (EInventoryJournalOp)Record.Op;
+			UClass* ItemClass = ItemClasses.IsValidIndex(Record.ClassIndex) ? ItemClasses[Record.ClassIndex] : nullptr;
+			UInventoryComponent* Inventory = FindOrCreateInventory(Record.InventoryId);
+
+			const double StartTime = FPlatformTime::Seconds();
+
+			switch (Op)
+			{
+			case EInventoryJournalOp::Register:
+				Inventory->SetCapacity(Record.Quantity);
+				break;
+			case EInventoryJournalOp::WeightCapacity:
+				Inventory->SetWeightCapacity(Record.Quantity / 100.f);
+				break;
+			case EInventoryJournalOp::Add:
+				if (ItemClass)
+				{
+					const int32 NumItemsBefore = Inventory->GetNumItems();
+					Inventory->TryAddItemOfClass(ItemClass, Record.Quantity);
+
+					// A new stack is the item the journal goes on to refer to by this id.
+					if (!ReplayItems.Contains(Record.ItemId) && Inventory->GetNumItems() > NumItemsBefore)
+						ReplayItems.Add(Record.ItemId, Inventory->GetItems().Last());
+				}
+				break;
+			case EInventoryJournalOp::Consume:
+				if (UItem* Item = FindReplayItem(Inventory, Record, ItemClass))
+					Inventory->ConsumeItem(Item, Record.Quantity);
+				break;
+			case EInventoryJournalOp::Remove:
+				// A zero quantity remove came from a consume emptying the item, which the replayed consume already did.
+				if (UItem* Item = Record.Quantity > 0 ? FindReplayItem(Inventory, Record, ItemClass) : nullptr)
+					Inventory->RemoveItem(Item);
+
+				ReplayItems.Remove(Record.ItemId);
+				break;
+			case EInventoryJournalOp::Equip:
+				if (UEquippableItem* Equippable = Cast<UEquippableItem>(FindReplayItem(Inventory, Record, ItemClass)))
+					Equippable->SetEquipped(Record.Quantity != 0);
+				break;
+			default:
+				break;
+			}
+
+			OpSeconds[Record.Op] += FPlatformTime::Seconds() - StartTime;
+			++OpCounts[Record.Op];
+
+			if (Op >= EInventoryJournalOp::Add && Op <= EInventoryJournalOp::Equip && !ItemClass)
+				++NumSkipped;
+		}
+
+		for (const TPair<uint32, UInventoryComponent*>& Pair : Inventories)
+		{
+			Pair.Value->GetOwner()->Destroy();
+		}
+
+		CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+	}
+
+	double TotalSeconds = 0.0;
+	int64 TotalOps = 0;
+
+	UE_LOG(LogTemp, Display, TEXT("InventoryReplay: %d records x %d iterations from %s"), Records.Num(), Iterations, *JournalFilename);
+
+	for (int32 i = 0; i < InventoryReplay::NumOps; ++i)
+	{
+		if (OpCounts[i] == 0)
+			continue;
+
+		TotalSeconds += OpSeconds[i];
+		TotalOps += OpCounts[i];
+
+		UE_LOG(LogTemp, Display, TEXT("  %-16s %10lld ops %10.3f ms %12.0f ops/s"), InventoryReplay::OpNames[i], OpCounts[i], OpSeconds[i] * 1000.0,
+			OpSeconds[i] > 0.0 ? OpCounts[i] / OpSeconds[i] : 0.0);
+	}
+
+	UE_LOG(LogTemp, Display, TEXT("  %-16s %10lld ops %10.3f ms %12.0f ops/s, %lld records skipped for missing classes"), TEXT("Total"), TotalOps, TotalSeconds * 1000.0,
+		TotalSeconds > 0.0 ? TotalOps / TotalSeconds : 0.0, NumSkipped);
+
+	GEngine->DestroyWorldContext(World);
+	World->DestroyWorld(false);
+
+	return 0;
+}
@@ -0,0 +1,24 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "InventoryReplayCommandlet.generated.h"
+
+/**
+ * Replays an inventory journal recorded with inventory.Journal against fresh inventories as fast as possible and
+ * reports how long each kind of operation took.
+ *
+ * UnrealEditor-Cmd SurvivalGame -run=InventoryReplay -Journal=<path> [-Iterations=N]
+ */
+UCLASS()
+class SURVIVALGAME_API UInventoryReplayCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UInventoryReplayCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
@@ -0,0 +1,238 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Components/CraftingComponent.h"
+#include "Net/UnrealNetwork.h"
+#include "GameFramework/Pawn.h"
+
+#include "Components/InventoryComponent.h"
+#include "Items/CraftingRecipe.h"
+#include "Items/Item.h"
+#include "Player/SurvivalCharacter.h"
+#include "Player/SurvivalPlayerController.h"
+
+#define LOCTEXT_NAMESPACE "Crafting"
+
+UCraftingComponent::UCraftingComponent()
+{
+	SetIsReplicated(true);
+}
+
+bool UCraftingComponent::Craft(const int32 RecipeIndex, FText& OutErrorText)
+{
+	if (!GetOwner())
+		return false;
+
+	if (!GetOwner()->HasAuthority())
+	{
+		ServerCraft(RecipeIndex);
+		OutErrorText = FText::GetEmpty();
+		return false;
+	}
+
+	UInventoryComponent* Inventory = GetOwnerInventory();
+
+	if (!Inventory || !Recipes.IsValidIndex(RecipeIndex) || !Recipes[RecipeIndex])
+	{
+		OutErrorText = LOCTEXT("InvalidRecipeText", "Couldn't craft that.");
+		return false;
+	}
+
+	const UCraftingRecipe* Recipe = Recipes[RecipeIndex];
+
+	if (!IsRecipeCraftable(RecipeIndex))
+	{
+		OutErrorText = FText::Format(LOCTEXT("MissingIngredientsText", "Missing ingredients for {RecipeName}."), Recipe->RecipeDisplayName);
+		return false;
+	}
+
+	return Inventory->ExchangeItems(Recipe->Ingredients, Recipe->Products, OutErrorText);
+}
+
+void UCraftingComponent::ServerCraft_Implementation(const int32 RecipeIndex)
+{
+	const APawn* OwnerPawn = Cast<APawn>(GetOwner());
+
+	if (ASurvivalPlayerController* PlayerController = OwnerPawn ? Cast<ASurvivalPlayerController>(OwnerPawn->GetController()) : nullptr)
+	{
+		if (!PlayerController->ConsumeRpcToken(ERateLimitedRpc::RLR_Craft))
+			return;
+	}
+
+	FText ErrorText;
+	Craft(RecipeIndex, ErrorText);
+}
+
+bool UCraftingComponent::ServerCraft_Validate(const int32 RecipeIndex)
+{
+	const APawn* OwnerPawn = Cast<APawn>(GetOwner());
+	const ASurvivalPlayerController* PlayerController = OwnerPawn ? Cast<ASurvivalPlayerController>(OwnerPawn->GetController()) : nullptr;
+
+	return !(PlayerController && PlayerController->IsAbusingRpcs());
+}
+
+bool UCraftingComponent::IsRecipeCraftable(const int32 RecipeIndex) const
+{
+	if (RecipeIndex < 0 || !CraftableRecipeBits.IsValidIndex(RecipeIndex / 32))
+		return false;
+
+	return (CraftableRecipeBits[RecipeIndex / 32] & (1u << (RecipeIndex % 32))) != 0;
+}
+
+TArray<UCraftingRecipe*> UCraftingComponent::GetCraftableRecipes() const
+{
+	TArray<UCraftingRecipe*> CraftableRecipes;
+
+	for (int32 WordIndex = 0; WordIndex < CraftableRecipeBits.Num(); ++WordIndex)
+	{
+		uint32 Word = CraftableRecipeBits[WordIndex];
+
+		while (Word)
+		{
+			const int32 RecipeIndex = WordIndex * 32 + FMath::CountTrailingZeros(Word);
+			Word &= Word - 1;
+
+			if (Recipes.IsValidIndex(RecipeIndex))
+				CraftableRecipes.Add(Recipes[RecipeIndex]);
+		}
+	}
+
+	return CraftableRecipes;
+}
+
+void UCraftingComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (!GetOwner()->HasAuthority())
+		return;
+
+	if (UInventoryComponent* Inventory = GetOwnerInventory())
+	{
+		ItemQuantityChangedHandle = Inventory->OnItemQuantityChanged.AddUObject(this, &UCraftingComponent::OnItemQuantityChanged);
+		CompileRecipes();
+	}
+}
+
+void UCraftingComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UInventoryComponent* Inventory = GetOwnerInventory())
+		Inventory->OnItemQuantityChanged.Remove(ItemQuantityChangedHandle);
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void UCraftingComponent::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME_CONDITION(UCraftingComponent, CraftableRecipeBits, COND_OwnerOnly);
+}
+
+void UCraftingComponent::OnRep_CraftableRecipeBits()
+{
+	OnCraftableRecipesChanged.Broadcast();
+}
+
+UInventoryComponent* UCraftingComponent::GetOwnerInventory() const
+{
+	const ASurvivalCharacter* Character = Cast<ASurvivalCharacter>(GetOwner());
+	return Character ? Character->PlayerInventory : nullptr;
+}
+
+void UCraftingComponent::CompileRecipes()
+{
+	CompiledRecipes.SetNum(Recipes.Num());
+	RecipesByIngredient.Reset();
+	IngredientCounts.Reset();
+	CraftableRecipeBits.Init(0, FMath::DivideAndRoundUp(Recipes.Num(), 32));
+
+	for (int32 RecipeIndex = 0; RecipeIndex < Recipes.Num(); ++RecipeIndex)
+	{
+		FCompiledRecipe& Compiled = CompiledRecipes[RecipeIndex];
+		Compiled.Requirements.Reset();
+
+		if (!Recipes[RecipeIndex])
+			continue;
+
+		for (const FItemQuantity& Ingredient : Recipes[RecipeIndex]->Ingredients)
+		{
+			if (!Ingredient.ItemClass || Ingredient.Quantity <= 0)
+				continue;
+
+			TPair<UClass*, int32>* Requirement = Compiled.Requirements.FindByPredicate([&Ingredient](const TPair<UClass*, int32>& Existing)
+			{
+				return Existing.Key == Ingredient.ItemClass;
+			});
+
+			if (Requirement)
+				Requirement->Value += Ingredient.Quantity;
+			else
+				Compiled.Requirements.Emplace(Ingredient.ItemClass, Ingredient.Quantity);
+
+			RecipesByIngredient.FindOrAdd(Ingredient.ItemClass).AddUnique(RecipeIndex);
+		}
+	}
+
+	if (const UInventoryComponent* Inventory = GetOwnerInventory())
+	{
+		for (const UItem* Item : Inventory->GetItems())
+		{
+			if (Item && RecipesByIngredient.Contains(Item->GetClass()))
+				IngredientCounts.FindOrAdd(Item->GetClass()) += Item->GetQuantity();
+		}
+	}
+
+	for (int32 RecipeIndex = 0; RecipeIndex < Recipes.Num(); ++RecipeIndex)
+	{
+		EvaluateRecipe(RecipeIndex);
+	}
+
+	OnCraftableRecipesChanged.Broadcast();
+}
+
+void UCraftingComponent::OnItemQuantityChanged(UClass* ItemClass, const int32 Delta)
+{
+	const TArray<int32>* DependentRecipes = RecipesByIngredient.Find(ItemClass);
+
+	if (!DependentRecipes)
+		return;
+
+	int32& Count = IngredientCounts.FindOrAdd(ItemClass);
+	Count = FMath::Max(Count + Delta, 0);
+
+	bool bChanged = false;
+
+	for (const int32 RecipeIndex : *DependentRecipes)
+	{
+		bChanged |= EvaluateRecipe(RecipeIndex);
+	}
+
+	if (bChanged)
+		OnCraftableRecipesChanged.Broadcast();
+}
+
+bool UCraftingComponent::EvaluateRecipe(const int32 RecipeIndex)
+{
+	// Recipes without a valid asset are never craftable, recipes without ingredients always are.
+	bool bCraftable = Recipes[RecipeIndex] != nullptr;
+
+	for (const TPair<UClass*, int32>& Requirement : CompiledRecipes[RecipeIndex].Requirements)
+	{
+		const int32* Count = IngredientCounts.Find(Requirement.Key);
+
+		if (!Count || *Count < Requirement.Value)
+		{
+			bCraftable = false;
+			break;
+		}
+	}
+
+	if (bCraftable == IsRecipeCraftable(RecipeIndex))
+		return false;
+
+	CraftableRecipeBits[RecipeIndex / 32] ^= 1u << (RecipeIndex % 32);
+	return true;
+}
+
+#undef LOCTEXT_NAMESPACE
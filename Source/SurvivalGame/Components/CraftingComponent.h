@@ -0,0 +1,92 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "CraftingComponent.generated.h"
+
+// Called on the server and owning client whenever a recipe becomes craftable or stops being craftable.
+DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnCraftableRecipesChanged);
+
+/**
+ * Crafts from the owning pawn's PlayerInventory. Recipes are compiled into an index from ingredient class to the
+ * recipes using it, and the server keeps a per class count of the inventory up to date from its quantity changes, so
+ * a change only re-evaluates the recipes that use that class. The resulting craftable set replicates to the owner
+ * as a bitset, one bit per entry in Recipes.
+ */
+UCLASS(ClassGroup = (Custom), meta = (BlueprintSpawnableComponent))
+class SURVIVALGAME_API UCraftingComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	UCraftingComponent();
+
+	// Consumes the recipe's ingredients and adds its products as one transaction. Clients ask the server and get false
+	// with no error text, the inventory replicating back is the answer.
+	UFUNCTION(BlueprintCallable, Category = "Crafting")
+	bool Craft(const int32 RecipeIndex, FText& OutErrorText);
+
+	UFUNCTION(BlueprintPure, Category = "Crafting")
+	bool IsRecipeCraftable(const int32 RecipeIndex) const;
+
+	UFUNCTION(BlueprintCallable, Category = "Crafting")
+	TArray<class UCraftingRecipe*> GetCraftableRecipes() const;
+
+	UFUNCTION(BlueprintPure, Category = "Crafting")
+	FORCEINLINE TArray<class UCraftingRecipe*> GetRecipes() const { return Recipes; }
+
+	// Bit RecipeIndex % 32 of word RecipeIndex / 32 is set while that recipe is craftable.
+	FORCEINLINE const TArray<uint32>& GetCraftableRecipeBits() const { return CraftableRecipeBits; }
+
+	UPROPERTY(BlueprintAssignable, Category = "Crafting")
+	FOnCraftableRecipesChanged OnCraftableRecipesChanged;
+
+protected:
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+	// Indices into this are what the craftable bitset and Craft use, so only append to it once players can see it.
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Crafting")
+	TArray<class UCraftingRecipe*> Recipes;
+
+private:
+
+	UFUNCTION(Server, Reliable, WithValidation)
+	void ServerCraft(const int32 RecipeIndex);
+
+	UFUNCTION()
+	void OnRep_CraftableRecipeBits();
+
+	class UInventoryComponent* GetOwnerInventory() const;
+
+	// Builds the ingredient index, then counts what the inventory holds and evaluates every recipe once.
+	void CompileRecipes();
+
+	void OnItemQuantityChanged(UClass* ItemClass, const int32 Delta);
+
+	// Returns whether the recipe's bit changed.
+	bool EvaluateRecipe(const int32 RecipeIndex);
+
+	UPROPERTY(ReplicatedUsing = OnRep_CraftableRecipeBits)
+	TArray<uint32> CraftableRecipeBits;
+
+	// A recipe's ingredients with duplicate classes merged.
+	struct FCompiledRecipe
+	{
+		TArray<TPair<UClass*, int32>> Requirements;
+	};
+
+	TArray<FCompiledRecipe> CompiledRecipes;
+
+	// Ingredient class to the recipes that use it.
+	TMap<UClass*, TArray<int32>> RecipesByIngredient;
+
+	// What the inventory holds of each ingredient class, classes no recipe uses aren't tracked.
+	TMap<UClass*, int32> IngredientCounts;
+
+	FDelegateHandle ItemQuantityChangedHandle;
+};
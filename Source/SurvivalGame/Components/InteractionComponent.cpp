@@ -5,13 +5,16 @@
 
 #include "Player/SurvivalCharacter.h"
 #include "Widgets/InteractionWidget.h"
+#include "World/InteractableSignificanceSubsystem.h"
 
 UInteractionComponent::UInteractionComponent()
 	:InteractionTime(0.f),
 	InteractionDistance(200.f),
 	InteractableNameText(FText::FromString(TEXT("Interactable Object"))),
 	InteractableActionText(FText::FromString(TEXT("Interact"))),
-	bAllowMultipleInteractors(true)
+	bAllowMultipleInteractors(true),
+	bSignificant(true),
+	SignificantNetUpdateFrequency(0.f)
 {
 	SetComponentTickEnabled(false);
 
@@ -25,6 +28,25 @@ UInteractionComponent::UInteractionComponent()
 	SetHiddenInGame(true);
 }
 
+void UInteractionComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (GetOwner())
+		SignificantNetUpdateFrequency = GetOwner()->NetUpdateFrequency;
+
+	if (UInteractableSignificanceSubsystem* SignificanceSubsystem = GetWorld()->GetSubsystem<UInteractableSignificanceSubsystem>())
+		SignificanceSubsystem->RegisterInteractable(this);
+}
+
+void UInteractionComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UInteractableSignificanceSubsystem* SignificanceSubsystem = GetWorld()->GetSubsystem<UInteractableSignificanceSubsystem>())
+		SignificanceSubsystem->UnregisterInteractable(this);
+
+	Super::EndPlay(EndPlayReason);
+}
+
 void UInteractionComponent::SetInteractableNameText(const FText& NewNameText)
 {
 	InteractableNameText = NewNameText;
@@ -108,21 +130,57 @@ void UInteractionComponent::Interact(ASurvivalCharacter* Character)
 	OnInteract.Broadcast(Character);
 }
 
-float UInteractionComponent::GetInteractPercentage()
+void UInteractionComponent::SetRemoteInteractor(ASurvivalCharacter* Character, const bool bInteracting)
 {
-	if (!Interactors.IsValidIndex(0))
-		return 0.f;
+	if (!Character)
+		return;
 
-	if (auto* Interactor = Interactors[0])
+	if (bInteracting)
+		Interactors.AddUnique(Character);
+	else
+		Interactors.RemoveSingle(Character);
+}
+
+float UInteractionComponent::GetInteractPercentage()
+{
+	for (ASurvivalCharacter* Interactor : Interactors)
 	{
-		return 1.f - FMath::Abs(Interactor->GetRemainingInerteractTime() / InteractionTime);
+		if (Interactor && Interactor->GetInteractionProgress().Interactable == this)
+			return Interactor->GetInteractionProgress().GetPercentage(GetWorld());
 	}
 
 	return 0.0f;
 }
 
+void UInteractionComponent::SetSignificant(const bool bNewSignificant)
+{
+	if (bSignificant == bNewSignificant)
+		return;
+
+	bSignificant = bNewSignificant;
+
+	AActor* Owner = GetOwner();
+
+	if (Owner && Owner->HasAuthority())
+	{
+		const UInteractableSignificanceSubsystem* SignificanceSubsystem = GetWorld()->GetSubsystem<UInteractableSignificanceSubsystem>();
+
+		if (SignificanceSubsystem)
+			Owner->NetUpdateFrequency = bSignificant ? SignificantNetUpdateFrequency : FMath::Min(SignificantNetUpdateFrequency, SignificanceSubsystem->GetInsignificantNetUpdateFrequency());
+	}
+
+	// Changes made while we were insignificant never made it to the widget.
+	if (bSignificant)
+		RefreshWidget();
+
+	OnSignificanceChanged.Broadcast(bSignificant);
+}
+
 void UInteractionComponent::RefreshWidget()
 {
+	if (!bSignificant)
+		return;
+
 	if (!bHiddenInGame && GetOwner()->GetNetMode() != NM_DedicatedServer)
 	{
 		if (UInteractionWidget* InteractionWidget = Cast<UInteractionWidget>(GetUserWidgetObject()))
@@ -13,6 +13,8 @@ DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnBeginFocus, class ASurvivalCharac
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnEndFocus, class ASurvivalCharacter*, Character);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnInteract, class ASurvivalCharacter*, Character);
 
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnSignificanceChanged, bool);
+
 UCLASS(ClassGroup = (Custom), meta = (BlueprintSpawnableComponent))
 class SURVIVALGAME_API UInteractionComponent : public UWidgetComponent
 {
@@ -52,11 +54,19 @@ public:
 
 	void Interact(class ASurvivalCharacter* Character);
 
+	// Other players interacting with us, only tracked so their progress can be shown.
+	void SetRemoteInteractor(class ASurvivalCharacter* Character, const bool bInteracting);
+
 	UFUNCTION(BlueprintPure, Category = "Interaction")
 	float GetInteractPercentage();
 	
 	void RefreshWidget();
 
+	// Insignificant interactables are too far from or too far behind every player to be worth updating.
+	void SetSignificant(const bool bNewSignificant);
+
+	FORCEINLINE bool IsSignificant() const { return bSignificant; }
+
 public:
 	UPROPERTY(EditDefaultsOnly, BlueprintAssignable)
 	FOnBeginInteract OnBeginInteract;
@@ -73,12 +83,24 @@ public:
 	UPROPERTY(EditDefaultsOnly, BlueprintAssignable)
 	FOnInteract OnInteract;
 
+	FOnSignificanceChanged OnSignificanceChanged;
+
 
 protected:
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 	virtual void Deactivate() override;
 	
 	bool CanInteract(class ASurvivalCharacter* Character) const;
 
 	UPROPERTY()
 	TArray<class ASurvivalCharacter*> Interactors;
+
+private:
+
+	bool bSignificant;
+
+	// The owner's own net update frequency, restored when we become significant again.
+	float SignificantNetUpdateFrequency;
 };
@@ -4,8 +4,16 @@
 #include "Components/InventoryComponent.h"
 #include "Net/UnrealNetwork.h"
 #include "Engine/ActorChannel.h"
+#include "Engine/NetConnection.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/Pawn.h"
 
 #include "Items/Item.h"
+#include "Items/EquippableItem.h"
+#include "Player/SurvivalPlayerController.h"
+#include "Components/InventoryJournal.h"
+#include "Items/ItemPoolSubsystem.h"
+#include "Items/ItemTagBits.h"
 
 #define LOCTEXT_NAMESPACE "Inventory"
 
@@ -13,6 +21,16 @@
 UInventoryComponent::UInventoryComponent()
 {
 	SetIsReplicated(true);
+
+	ReplicationPolicy = EInventoryReplicationPolicy::IRP_Everyone;
+	OwnerItemsKey = INDEX_NONE;
+	ViewerItems = nullptr;
+	ViewerItemsKey = INDEX_NONE;
+
+	bUseGrid = false;
+	GridDimensions = FIntPoint(10, 6);
+
+	DefaultSortKeys = { EInventorySortKey::ISK_Rarity, EInventorySortKey::ISK_Class };
 }
 
 FItemAddResult UInventoryComponent::TryAddItem(UItem* Item)
@@ -22,10 +40,18 @@ FItemAddResult UInventoryComponent::TryAddItem(UItem* Item)
 
 FItemAddResult UInventoryComponent::TryAddItemOfClass(TSubclassOf<class UItem> ItemClass, const int32 Quantity)
 {
-	UItem* Item = NewObject<UItem>(GetOwner(), ItemClass);
+	UItem* Item = UItemPoolSubsystem::AcquireItem(GetOwner(), ItemClass);
+	if (!Item)
+		return FItemAddResult::AddedNone(Quantity, LOCTEXT("InvalidItemClassText", "Couldn't create item."));
+
 	Item->SetQuantity(Quantity);
 
-	return TryAddItem_Internal(Item);
+	const FItemAddResult AddResult = TryAddItem_Internal(Item);
+
+	// Only ever used to describe what to add, whatever was added is a copy.
+	UItemPoolSubsystem::ReleaseItem(Item);
+
+	return AddResult;
 }
 
 int32 UInventoryComponent::ConsumeItem(UItem* Item)
@@ -47,6 +73,8 @@ int32 UInventoryComponent::ConsumeItem(UItem* Item, const int32 Quantity)
 
 	Item->SetQuantity(Item->GetQuantity() - RemoveQuantity);
 
+	FInventoryJournal::Record(this, EInventoryJournalOp::Consume, Item, RemoveQuantity);
+
 	if (Item->GetQuantity() <= 0)
 	{
 		RemoveItem(Item);
@@ -64,8 +92,546 @@ bool UInventoryComponent::RemoveItem(class UItem* Item)
 	if (!GetOwner()->HasAuthority() || !Item)
 		return false;
 
-	Items.RemoveSingle(Item);
+	if (Items.RemoveSingle(Item) > 0)
+		FInventoryJournal::Record(this, EInventoryJournalOp::Remove, Item, Item->GetQuantity());
+
 	ReplicatedItemsKey++;
+	FreeGridCells(Item);
+
+	OnItemRemoved.Broadcast(Item);
+
+	if (Item->GetQuantity() > 0)
+		NotifyQuantityChanged(Item->GetClass(), -Item->GetQuantity());
+
+	// Stops a stale item from passing ownership checks or reporting quantity changes to us.
+	Item->OwningInventory = nullptr;
+
+	return true;
+}
+
+void UInventoryComponent::ConsolidateAndSort(const TArray<EInventorySortKey>& SortKeys)
+{
+	if (!GetOwner())
+		return;
+
+	if (!GetOwner()->HasAuthority())
+	{
+		ServerConsolidateAndSort(SortKeys);
+		return;
+	}
+
+	// Quantities are edited directly rather than through SetQuantity so nothing is dirtied until the end.
+	TMap<UClass*, UItem*> PartialStacks;
+	TSet<UItem*> ModifiedItems;
+
+	for (UItem* Item : Items)
+	{
+		if (!Item || !Item->bIsStackable || Item->Quantity <= 0)
+			continue;
+
+		UItem** PartialStack = PartialStacks.Find(Item->GetClass());
+
+		if (!PartialStack)
+		{
+			if (Item->Quantity < Item->MaxStackSize)
+				PartialStacks.Add(Item->GetClass(), Item);
+
+			continue;
+		}
+
+		UItem* Target = *PartialStack;
+		const int32 MoveAmount = FMath::Min(Item->Quantity, Target->MaxStackSize - Target->Quantity);
+
+		Target->Quantity += MoveAmount;
+		Item->Quantity -= MoveAmount;
+
+		ModifiedItems.Add(Target);
+		ModifiedItems.Add(Item);
+
+		if (Target->Quantity >= Target->MaxStackSize)
+		{
+			// Whatever is left over becomes the stack the next one tops up.
+			if (Item->Quantity > 0 && Item->Quantity < Item->MaxStackSize)
+				*PartialStack = Item;
+			else
+				PartialStacks.Remove(Item->GetClass());
+		}
+	}
+
+	for (UItem* Item : Items)
+	{
+		if (Item && Item->Quantity <= 0)
+		{
+			FreeGridCells(Item);
+			Item->OwningInventory = nullptr;
+		}
+	}
+
+	Items.RemoveAll([](const UItem* Item) { return !Item || Item->Quantity <= 0; });
+
+	Items.StableSort([&SortKeys](const UItem& A, const UItem& B)
+	{
+		for (const EInventorySortKey SortKey : SortKeys)
+		{
+			switch (SortKey)
+			{
+			case EInventorySortKey::ISK_Rarity:
+				if (A.Rarity != B.Rarity)
+					return A.Rarity > B.Rarity;
+				break;
+			case EInventorySortKey::ISK_Weight:
+				// Exact comparison, a tolerance here wouldn't be a strict weak ordering.
+				if (A.GetStackWeight() != B.GetStackWeight())
+					return A.GetStackWeight() > B.GetStackWeight();
+				break;
+			case EInventorySortKey::ISK_Class:
+				if (A.GetClass() != B.GetClass())
+					return A.GetClass()->GetFName().LexicalLess(B.GetClass()->GetFName());
+				break;
+			}
+		}
+
+		return false;
+	});
+
+	for (UItem* Item : ModifiedItems)
+	{
+		Item->RepKey++;
+	}
+
+	ReplicatedItemsKey++;
+}
+
+void UInventoryComponent::ConsolidateAndSortDefault()
+{
+	ConsolidateAndSort(DefaultSortKeys);
+}
+
+void UInventoryComponent::ServerConsolidateAndSort_Implementation(const TArray<EInventorySortKey>& SortKeys)
+{
+	const APawn* OwnerPawn = Cast<APawn>(GetOwner());
+
+	if (ASurvivalPlayerController* PlayerController = OwnerPawn ? Cast<ASurvivalPlayerController>(OwnerPawn->GetController()) : nullptr)
+	{
+		if (!PlayerController->ConsumeRpcToken(ERateLimitedRpc::RLR_SortInventory))
+			return;
+	}
+
+	ConsolidateAndSort(SortKeys);
+}
+
+bool UInventoryComponent::ServerConsolidateAndSort_Validate(const TArray<EInventorySortKey>& SortKeys)
+{
+	// Each key only needs to appear once, so a longer list than there are keys is never legitimate.
+	if (SortKeys.Num() > (int32)EInventorySortKey::ISK_Class + 1)
+		return false;
+
+	for (const EInventorySortKey SortKey : SortKeys)
+	{
+		if (SortKey > EInventorySortKey::ISK_Class)
+			return false;
+	}
+
+	return true;
+}
+
+namespace InventoryTransaction
+{
+	struct FPlannedMove
+	{
+		UItem* Item = nullptr;
+		UInventoryComponent* Source = nullptr;
+		UInventoryComponent* Destination = nullptr;
+		int32 Quantity = 0;
+
+		// Existing destination stacks to top up, and by how much.
+		TArray<TPair<UItem*, int32>> TopUps;
+
+		// Whatever doesn't fit in existing stacks lands in a stack of its own.
+		int32 NewStackQuantity = 0;
+
+		// Where the new stack goes in a grid destination.
+		FInventoryGridPlacement Placement;
+	};
+
+	struct FProjectedInventory
+	{
+		int32 SlotDelta = 0;
+		float WeightDelta = 0.f;
+
+		// Copy of a grid inventory's occupancy, only made once a move needs it.
+		FInventoryGrid Grid;
+		bool bHasGrid = false;
+	};
+}
+
+bool UInventoryComponent::MoveItems(const TArray<FInventoryItemMove>& Moves, FText& OutErrorText)
+{
+	using namespace InventoryTransaction;
+
+	TArray<FPlannedMove> Plan;
+	TMap<UInventoryComponent*, FProjectedInventory> Projected;
+	TMap<UItem*, int32> ProjectedQuantities;
+	TSet<UItem*> MovingItems;
+
+	auto GetProjectedGrid = [](FProjectedInventory& ProjectedInventory, const UInventoryComponent* Inventory) -> FInventoryGrid&
+	{
+		if (!ProjectedInventory.bHasGrid)
+		{
+			ProjectedInventory.Grid = Inventory->Grid;
+			ProjectedInventory.bHasGrid = true;
+		}
+
+		return ProjectedInventory.Grid;
+	};
+
+	for (const FInventoryItemMove& Move : Moves)
+	{
+		if (Move.Item)
+			MovingItems.Add(Move.Item);
+	}
+
+	if (MovingItems.Num() != Moves.Num())
+	{
+		OutErrorText = LOCTEXT("MoveInvalidText", "Couldn't move that item.");
+		return false;
+	}
+
+	// Validate: nothing is touched until every move is known to fit.
+	for (const FInventoryItemMove& Move : Moves)
+	{
+		UItem* Item = Move.Item;
+		UInventoryComponent* Source = Item ? Item->OwningInventory : nullptr;
+		UInventoryComponent* Destination = Move.Destination;
+
+		if (!Item || !Source || !Destination || Source == Destination || !Source->Items.Contains(Item))
+		{
+			OutErrorText = LOCTEXT("MoveInvalidText", "Couldn't move that item.");
+			return false;
+		}
+
+		if (!Source->GetOwner() || !Source->GetOwner()->HasAuthority() || !Destination->GetOwner() || !Destination->GetOwner()->HasAuthority())
+		{
+			OutErrorText = LOCTEXT("IsNotServerText", "Clients cannot add items.");
+			return false;
+		}
+
+		if (UEquippableItem* EquippableItem = Cast<UEquippableItem>(Item))
+		{
+			if (EquippableItem->IsEquipped())
+			{
+				OutErrorText = FText::Format(LOCTEXT("MoveEquippedText", "Unequip {ItemName} before moving it."), Item->ItemDisplayName);
+				return false;
+			}
+		}
+
+		const int32 ItemQuantity = ProjectedQuantities.FindOrAdd(Item, Item->GetQuantity());
+		const int32 MoveQuantity = Move.Quantity > 0 ? Move.Quantity : ItemQuantity;
+
+		if (MoveQuantity > ItemQuantity)
+		{
+			OutErrorText = LOCTEXT("MoveInvalidText", "Couldn't move that item.");
+			return false;
+		}
+
+		FPlannedMove& Planned = Plan.AddDefaulted_GetRef();
+		Planned.Item = Item;
+		Planned.Source = Source;
+		Planned.Destination = Destination;
+		Planned.Quantity = MoveQuantity;
+
+		int32 Remaining = MoveQuantity;
+
+		if (Item->bIsStackable)
+		{
+			for (UItem* DestinationItem : Destination->Items)
+			{
+				if (Remaining <= 0)
+					break;
+
+				if (!DestinationItem || DestinationItem->GetClass() != Item->GetClass() || MovingItems.Contains(DestinationItem))
+					continue;
+
+				int32& DestinationQuantity = ProjectedQuantities.FindOrAdd(DestinationItem, DestinationItem->GetQuantity());
+				const int32 TopUpAmount = FMath::Min(Remaining, DestinationItem->MaxStackSize - DestinationQuantity);
+
+				if (TopUpAmount > 0)
+				{
+					Planned.TopUps.Emplace(DestinationItem, TopUpAmount);
+					DestinationQuantity += TopUpAmount;
+					Remaining -= TopUpAmount;
+				}
+			}
+		}
+
+		Planned.NewStackQuantity = Remaining;
+		ProjectedQuantities[Item] = ItemQuantity - MoveQuantity;
+
+		// Adding the destination can grow the map, so the source is only looked up once both are in.
+		Projected.FindOrAdd(Source);
+		FProjectedInventory& ProjectedDestination = Projected.FindOrAdd(Destination);
+		FProjectedInventory& ProjectedSource = Projected.FindChecked(Source);
+
+		if (Remaining > 0)
+			ProjectedDestination.SlotDelta++;
+
+		if (MoveQuantity == ItemQuantity)
+			ProjectedSource.SlotDelta--;
+
+		if (MoveQuantity == ItemQuantity && Source->bUseGrid)
+			GetProjectedGrid(ProjectedSource, Source).Free(Item->GridPosition, Item->GetGridFootprint());
+
+		if (Remaining > 0 && Destination->bUseGrid)
+		{
+			FInventoryGrid& DestinationGrid = GetProjectedGrid(ProjectedDestination, Destination);
+
+			if (!DestinationGrid.FindPlacement(Item->GridSize, Planned.Placement))
+			{
+				OutErrorText = FText::Format(LOCTEXT("InventoryGridFullText", "No room for {ItemName}."), Item->ItemDisplayName);
+				return false;
+			}
+
+			DestinationGrid.Occupy(Planned.Placement.Position, FInventoryGrid::GetFootprint(Item->GridSize, Planned.Placement.bRotated));
+		}
+
+		ProjectedSource.WeightDelta -= MoveQuantity * Item->Weight;
+		ProjectedDestination.WeightDelta += MoveQuantity * Item->Weight;
+	}
+
+	for (const TPair<UInventoryComponent*, FProjectedInventory>& Pair : Projected)
+	{
+		const UInventoryComponent* Inventory = Pair.Key;
+		const FProjectedInventory& Change = Pair.Value;
+
+		if (Change.SlotDelta > 0 && Inventory->Items.Num() + Change.SlotDelta > Inventory->GetCapacity())
+		{
+			OutErrorText = LOCTEXT("InventoryCapacityFullText", "Inventory is full.");
+			return false;
+		}
+
+		if (Change.WeightDelta > 0.f && Inventory->GetCurrentWeight() + Change.WeightDelta > Inventory->GetWeightCapacity())
+		{
+			OutErrorText = LOCTEXT("InventoryTooMuchWeightText", "Carrying Too Much Weight.");
+			return false;
+		}
+	}
+
+	// Commit: every move is known to fit, so nothing below can fail half way.
+	for (const FPlannedMove& Planned : Plan)
+	{
+		UItem* Item = Planned.Item;
+
+		for (const TPair<UItem*, int32>& TopUp : Planned.TopUps)
+		{
+			TopUp.Key->SetQuantity(TopUp.Key->GetQuantity() + TopUp.Value);
+		}
+
+		const int32 SourceQuantity = Item->GetQuantity() - Planned.Quantity;
+
+		if (SourceQuantity <= 0 && Planned.NewStackQuantity > 0)
+		{
+			// The whole stack is going, hand the instance itself over instead of copying it.
+			Planned.Source->Items.RemoveSingle(Item);
+			Planned.Source->ReplicatedItemsKey++;
+			Planned.Source->FreeGridCells(Item);
+			Planned.Source->OnItemRemoved.Broadcast(Item);
+			Planned.Source->NotifyQuantityChanged(Item->GetClass(), -Item->GetQuantity());
+			Item->OwningInventory = nullptr;
+
+			Item->Rename(nullptr, Planned.Destination->GetOwner(), REN_DontCreateRedirectors | REN_NonTransactional | REN_DoNotDirty | REN_ForceNoResetLoaders);
+			Item->SetQuantity(Planned.NewStackQuantity);
+			Planned.Destination->AttachItem(Item, &Planned.Placement);
+			continue;
+		}
+
+		if (SourceQuantity <= 0)
+			Planned.Source->RemoveItem(Item);
+		else
+			Item->SetQuantity(SourceQuantity);
+
+		if (Planned.NewStackQuantity > 0)
+		{
+			UItem* SplitItem = UItemPoolSubsystem::AcquireItem(Planned.Destination->GetOwner(), Item->GetClass());
+			SplitItem->SetQuantity(Planned.NewStackQuantity);
+			Planned.Destination->AttachItem(SplitItem, &Planned.Placement);
+		}
+	}
+
+	for (const TPair<UInventoryComponent*, FProjectedInventory>& Pair : Projected)
+	{
+		Pair.Key->ClientRefreshInventory();
+	}
+
+	return true;
+}
+
+bool UInventoryComponent::ExchangeItems(const TArray<FItemQuantity>& ToConsume, const TArray<FItemQuantity>& ToAdd, FText& OutErrorText)
+{
+	if (!GetOwner() || !GetOwner()->HasAuthority())
+	{
+		OutErrorText = LOCTEXT("IsNotServerText", "Clients cannot add items.");
+		return false;
+	}
+
+	struct FPlannedStack
+	{
+		UClass* ItemClass = nullptr;
+		int32 Quantity = 0;
+		FInventoryGridPlacement Placement;
+	};
+
+	TMap<UItem*, int32> ProjectedQuantities;
+	TArray<FPlannedStack> NewStacks;
+	int32 SlotDelta = 0;
+	float WeightDelta = 0.f;
+
+	FInventoryGrid ProjectedGrid;
+	if (bUseGrid)
+		ProjectedGrid = Grid;
+
+	// Validate: nothing is touched until everything is known to fit.
+	for (const FItemQuantity& Consume : ToConsume)
+	{
+		if (!Consume.ItemClass || Consume.Quantity <= 0)
+			continue;
+
+		TArray<UItem*> Stacks = Items.FilterByPredicate([&Consume](const UItem* Item) { return Item && Item->GetClass() == Consume.ItemClass; });
+
+		// Smallest stacks first, so as many slots as possible free up for what is added.
+		Stacks.Sort([](const UItem& A, const UItem& B) { return A.GetQuantity() < B.GetQuantity(); });
+
+		int32 Remaining = Consume.Quantity;
+
+		for (UItem* Stack : Stacks)
+		{
+			if (Remaining <= 0)
+				break;
+
+			int32& StackQuantity = ProjectedQuantities.FindOrAdd(Stack, Stack->GetQuantity());
+			const int32 TakeAmount = FMath::Min(Remaining, StackQuantity);
+
+			if (TakeAmount <= 0)
+				continue;
+
+			StackQuantity -= TakeAmount;
+			Remaining -= TakeAmount;
+			WeightDelta -= TakeAmount * Stack->Weight;
+
+			if (StackQuantity <= 0)
+			{
+				SlotDelta--;
+
+				if (bUseGrid)
+					ProjectedGrid.Free(Stack->GridPosition, Stack->GetGridFootprint());
+			}
+		}
+
+		if (Remaining > 0)
+		{
+			OutErrorText = FText::Format(LOCTEXT("ExchangeMissingItemsText", "Not enough {ItemName}."), Consume.ItemClass->GetDefaultObject<UItem>()->ItemDisplayName);
+			return false;
+		}
+	}
+
+	for (const FItemQuantity& Add : ToAdd)
+	{
+		if (!Add.ItemClass || Add.Quantity <= 0)
+			continue;
+
+		const UItem* DefaultItem = Add.ItemClass->GetDefaultObject<UItem>();
+		int32 Remaining = Add.Quantity;
+
+		WeightDelta += Remaining * DefaultItem->Weight;
+
+		if (DefaultItem->bIsStackable)
+		{
+			for (UItem* Item : Items)
+			{
+				if (Remaining <= 0)
+					break;
+
+				if (!Item || Item->GetClass() != Add.ItemClass)
+					continue;
+
+				int32& ItemQuantity = ProjectedQuantities.FindOrAdd(Item, Item->GetQuantity());
+
+				// Used up by this exchange, so it is removed rather than topped back up.
+				if (ItemQuantity <= 0)
+					continue;
+
+				const int32 TopUpAmount = FMath::Min(Remaining, Item->MaxStackSize - ItemQuantity);
+
+				if (TopUpAmount > 0)
+				{
+					ItemQuantity += TopUpAmount;
+					Remaining -= TopUpAmount;
+				}
+			}
+		}
+
+		const int32 StackSize = DefaultItem->bIsStackable ? FMath::Max(DefaultItem->MaxStackSize, 1) : 1;
+
+		while (Remaining > 0)
+		{
+			FPlannedStack& NewStack = NewStacks.AddDefaulted_GetRef();
+			NewStack.ItemClass = Add.ItemClass;
+			NewStack.Quantity = FMath::Min(Remaining, StackSize);
+
+			Remaining -= NewStack.Quantity;
+			SlotDelta++;
+
+			if (bUseGrid)
+			{
+				if (!ProjectedGrid.FindPlacement(DefaultItem->GridSize, NewStack.Placement))
+				{
+					OutErrorText = FText::Format(LOCTEXT("InventoryGridFullText", "No room for {ItemName}."), DefaultItem->ItemDisplayName);
+					return false;
+				}
+
+				ProjectedGrid.Occupy(NewStack.Placement.Position, FInventoryGrid::GetFootprint(DefaultItem->GridSize, NewStack.Placement.bRotated));
+			}
+		}
+	}
+
+	if (SlotDelta > 0 && Items.Num() + SlotDelta > GetCapacity())
+	{
+		OutErrorText = LOCTEXT("InventoryCapacityFullText", "Inventory is full.");
+		return false;
+	}
+
+	if (WeightDelta > 0.f && GetCurrentWeight() + WeightDelta > GetWeightCapacity())
+	{
+		OutErrorText = LOCTEXT("InventoryTooMuchWeightText", "Carrying Too Much Weight.");
+		return false;
+	}
+
+	// Commit: consumed stacks go first so their grid cells are free for the new stacks.
+	for (const TPair<UItem*, int32>& Pair : ProjectedQuantities)
+	{
+		UItem* Item = Pair.Key;
+		const int32 QuantityDelta = Pair.Value - Item->GetQuantity();
+
+		if (QuantityDelta < 0)
+		{
+			ConsumeItem(Item, -QuantityDelta);
+		}
+		else if (QuantityDelta > 0)
+		{
+			Item->SetQuantity(Pair.Value);
+			FInventoryJournal::Record(this, EInventoryJournalOp::Add, Item, QuantityDelta);
+		}
+	}
+
+	for (const FPlannedStack& NewStack : NewStacks)
+	{
+		UItem* NewItem = UItemPoolSubsystem::AcquireItem(GetOwner(), NewStack.ItemClass);
+		NewItem->SetQuantity(NewStack.Quantity);
+		AttachItem(NewItem, bUseGrid ? &NewStack.Placement : nullptr);
+
+		FInventoryJournal::Record(this, EInventoryJournalOp::Add, NewItem, NewStack.Quantity);
+	}
+
+	ClientRefreshInventory();
 
 	return true;
 }
@@ -125,6 +691,140 @@ TArray<UItem*> UInventoryComponent::FindItemsByClass(TSubclassOf<class UItem> It
 	return ItemsOfClass;
 }
 
+int32 UInventoryComponent::GetItemCountByTag(const FGameplayTag Tag) const
+{
+	if (GetOwner() && GetOwner()->HasAuthority())
+	{
+		// Every class held has been compiled, so a tag without an index is on nothing held.
+		const int32 TagIndex = FItemTagBits::Get().FindTagIndex(Tag);
+		return TagCounts.IsValidIndex(TagIndex) ? TagCounts[TagIndex] : 0;
+	}
+
+	int32 Count = 0;
+
+	ForEachClassCount([&Tag, &Count](UClass* ItemClass, const int32 Quantity)
+	{
+		if (FItemTagBits::Get().ClassHasTag(ItemClass, Tag))
+			Count += Quantity;
+
+		return true;
+	});
+
+	return Count;
+}
+
+bool UInventoryComponent::HasItemWithTags(const FGameplayTagContainer& Tags, const bool bRequireAll) const
+{
+	if (Tags.IsEmpty())
+		return false;
+
+	if (!bRequireAll)
+	{
+		for (const FGameplayTag& Tag : Tags)
+		{
+			if (GetItemCountByTag(Tag) > 0)
+				return true;
+		}
+
+		return false;
+	}
+
+	bool bFound = false;
+
+	ForEachClassCount([&Tags, &bFound](UClass* ItemClass, const int32 Quantity)
+	{
+		bFound = true;
+
+		for (const FGameplayTag& Tag : Tags)
+		{
+			if (!FItemTagBits::Get().ClassHasTag(ItemClass, Tag))
+			{
+				bFound = false;
+				break;
+			}
+		}
+
+		return !bFound;
+	});
+
+	return bFound;
+}
+
+int32 UInventoryComponent::GetItemCountByTagQuery(const FGameplayTagQuery& Query) const
+{
+	int32 Count = 0;
+
+	ForEachClassCount([&Query, &Count](UClass* ItemClass, const int32 Quantity)
+	{
+		if (Query.Matches(ItemClass->GetDefaultObject<UItem>()->ItemTags))
+			Count += Quantity;
+
+		return true;
+	});
+
+	return Count;
+}
+
+UItem* UInventoryComponent::FindItemByTagQuery(const FGameplayTagQuery& Query) const
+{
+	UClass* MatchingClass = nullptr;
+
+	ForEachClassCount([&Query, &MatchingClass](UClass* ItemClass, const int32 Quantity)
+	{
+		if (Query.Matches(ItemClass->GetDefaultObject<UItem>()->ItemTags))
+			MatchingClass = ItemClass;
+
+		return MatchingClass == nullptr;
+	});
+
+	return MatchingClass ? FindItemByClass(MatchingClass) : nullptr;
+}
+
+void UInventoryComponent::NotifyQuantityChanged(UClass* ItemClass, const int32 Delta)
+{
+	if (!ItemClass || Delta == 0)
+		return;
+
+	int32& ClassCount = ClassCounts.FindOrAdd(ItemClass);
+	ClassCount += Delta;
+
+	if (ClassCount <= 0)
+		ClassCounts.Remove(ItemClass);
+
+	const TBitArray<>& ClassBits = FItemTagBits::Get().GetClassBits(ItemClass);
+
+	if (TagCounts.Num() < ClassBits.Num())
+		TagCounts.SetNumZeroed(ClassBits.Num());
+
+	for (TConstSetBitIterator<> It(ClassBits); It; ++It)
+	{
+		TagCounts[It.GetIndex()] += Delta;
+	}
+
+	OnItemQuantityChanged.Broadcast(ItemClass, Delta);
+}
+
+void UInventoryComponent::ForEachClassCount(TFunctionRef<bool(UClass*, int32)> Func) const
+{
+	if (GetOwner() && GetOwner()->HasAuthority())
+	{
+		for (const TPair<UClass*, int32>& ClassCount : ClassCounts)
+		{
+			if (!Func(ClassCount.Key, ClassCount.Value))
+				return;
+		}
+
+		return;
+	}
+
+	// OwningInventory isn't replicated, so clients never see the quantity changes the counts are built from.
+	for (const UItem* Item : Items)
+	{
+		if (Item && !Func(Item->GetClass(), Item->GetQuantity()))
+			return;
+	}
+}
+
 float UInventoryComponent::GetCurrentWeight() const
 {
 	float Weight = 0.f;
@@ -152,6 +852,38 @@ void UInventoryComponent::SetCapacity(const int32 NewCapacity)
 	OnInventoryUpdated.Broadcast();
 }
 
+void UInventoryComponent::AddViewer(APlayerController* Viewer)
+{
+	if (!Viewer || Viewers.Contains(Viewer))
+		return;
+
+	Viewers.Add(Viewer);
+
+	if (GetOwner())
+		GetOwner()->ForceNetUpdate();
+}
+
+void UInventoryComponent::RemoveViewer(APlayerController* Viewer)
+{
+	Viewers.RemoveAll([Viewer](const TWeakObjectPtr<APlayerController>& ExistingViewer)
+	{
+		return !ExistingViewer.IsValid() || ExistingViewer.Get() == Viewer;
+	});
+}
+
+bool UInventoryComponent::IsOwnerConnection(const UNetConnection* Connection) const
+{
+	return Connection && GetOwner() && GetOwner()->GetNetConnection() == Connection;
+}
+
+bool UInventoryComponent::IsViewer(const UNetConnection* Connection) const
+{
+	if (!Connection || !Connection->PlayerController)
+		return false;
+
+	return Viewers.Contains(Connection->PlayerController);
+}
+
 void UInventoryComponent::ClientRefreshInventory_Implementation()
 {
 	OnInventoryUpdated.Broadcast();
@@ -161,7 +893,9 @@ void UInventoryComponent::ClientRefreshInventory_Implementation()
 void UInventoryComponent::BeginPlay()
 {
 	Super::BeginPlay();
-	
+
+	if (bUseGrid && GetOwner()->HasAuthority())
+		Grid.Init(GridDimensions.X, GridDimensions.Y);
 }
 
 void UInventoryComponent::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
@@ -169,12 +903,49 @@ void UInventoryComponent::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>&
 	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
 
 	DOREPLIFETIME(UInventoryComponent, Items);
+	DOREPLIFETIME_CONDITION(UInventoryComponent, OwnerItems, COND_OwnerOnly);
+}
+
+void UInventoryComponent::PreReplication(IRepChangedPropertyTracker& ChangedPropertyTracker)
+{
+	Super::PreReplication(ChangedPropertyTracker);
+
+	const bool bOwnerOnly = ReplicationPolicy == EInventoryReplicationPolicy::IRP_OwnerOnly;
+	const bool bViewersOnly = ReplicationPolicy == EInventoryReplicationPolicy::IRP_ViewersOnly;
+
+	if (bOwnerOnly && OwnerItemsKey != ReplicatedItemsKey)
+	{
+		OwnerItems = Items;
+		OwnerItemsKey = ReplicatedItemsKey;
+	}
+
+	if (bViewersOnly && (!ViewerItems || ViewerItemsKey != ReplicatedItemsKey))
+	{
+		if (!ViewerItems)
+			ViewerItems = NewObject<UInventoryViewerItems>(this);
+
+		ViewerItems->Items = Items;
+		ViewerItemsKey = ReplicatedItemsKey;
+	}
+
+	DOREPLIFETIME_ACTIVE_OVERRIDE(UInventoryComponent, Items, !bOwnerOnly && !bViewersOnly);
+	DOREPLIFETIME_ACTIVE_OVERRIDE(UInventoryComponent, OwnerItems, bOwnerOnly);
 }
 
 bool UInventoryComponent::ReplicateSubobjects(UActorChannel* Channel, FOutBunch* Bunch, FReplicationFlags* RepFlags)
 {
 	bool bWroteToActorChannel = Super::ReplicateSubobjects(Channel, Bunch, RepFlags);
 
+	// Skipping the keys entirely means a connection that becomes a viewer later gets everything it missed.
+	if (ReplicationPolicy == EInventoryReplicationPolicy::IRP_ViewersOnly && !IsViewer(Channel->Connection))
+		return bWroteToActorChannel;
+
+	if (ReplicationPolicy == EInventoryReplicationPolicy::IRP_OwnerOnly && !IsOwnerConnection(Channel->Connection))
+		return bWroteToActorChannel;
+
+	if (ReplicationPolicy == EInventoryReplicationPolicy::IRP_ViewersOnly && ViewerItems)
+		bWroteToActorChannel |= Channel->ReplicateSubobject(ViewerItems, *Bunch, *RepFlags);
+
 	if (!Channel->KeyNeedsToReplicate(0, ReplicatedItemsKey))
 		return false;
 
@@ -195,6 +966,31 @@ void UInventoryComponent::OnRep_Items()
 	OnInventoryUpdated.Broadcast();
 }
 
+void UInventoryComponent::OnRep_OwnerItems()
+{
+	Items = OwnerItems;
+	OnRep_Items();
+}
+
+void UInventoryComponent::OnRep_ViewerItems(const UInventoryViewerItems* ReceivedItems)
+{
+	Items = ReceivedItems->Items;
+	OnRep_Items();
+}
+
+void UInventoryViewerItems::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME(UInventoryViewerItems, Items);
+}
+
+void UInventoryViewerItems::OnRep_Items()
+{
+	if (UInventoryComponent* Inventory = Cast<UInventoryComponent>(GetOuter()))
+		Inventory->OnRep_ViewerItems(this);
+}
+
 FItemAddResult UInventoryComponent::TryAddItem_Internal(UItem* Item)
 {
 	if (!GetOwner()->HasAuthority())
@@ -202,7 +998,7 @@ FItemAddResult UInventoryComponent::TryAddItem_Internal(UItem* Item)
 		UE_LOG(LogTemp, Warning, TEXT("202"));
 		return FItemAddResult::AddedNone(-1, LOCTEXT("IsNotServerText", "Clients cannot add items."));
 	}
-	
+
 	const int32 AddAmount = Item->GetQuantity();
 
 	if (Items.Num() + 1 > GetCapacity())
@@ -255,6 +1051,7 @@ FItemAddResult UInventoryComponent::TryAddItem_Internal(UItem* Item)
 				}
 
 				ExistingItem->SetQuantity(ExistingItem->GetQuantity() + ActualAddAmount);
+				FInventoryJournal::Record(this, EInventoryJournalOp::Add, ExistingItem, ActualAddAmount);
 
 				ensure(ExistingItem->GetQuantity() <= ExistingItem->MaxStackSize);
 
@@ -278,7 +1075,11 @@ FItemAddResult UInventoryComponent::TryAddItem_Internal(UItem* Item)
 		else
 		{
 			UE_LOG(LogTemp, Warning, TEXT("267"));
-			AddItem(Item);
+
+			if (!HasGridRoomFor(Item))
+				return FItemAddResult::AddedNone(AddAmount, FText::Format(LOCTEXT("InventoryGridFullText", "No room for {ItemName}."), Item->ItemDisplayName));
+
+			FInventoryJournal::Record(this, EInventoryJournalOp::Add, AddItem(Item), AddAmount);
 			return FItemAddResult::AddedAll(AddAmount);
 		}
 	}
@@ -287,7 +1088,10 @@ FItemAddResult UInventoryComponent::TryAddItem_Internal(UItem* Item)
 		UE_LOG(LogTemp, Warning, TEXT("NotStackable"));
 		ensure(Item->GetQuantity() == 1);
 
-		AddItem(Item);
+		if (!HasGridRoomFor(Item))
+			return FItemAddResult::AddedNone(AddAmount, FText::Format(LOCTEXT("InventoryGridFullText", "No room for {ItemName}."), Item->ItemDisplayName));
+
+		FInventoryJournal::Record(this, EInventoryJournalOp::Add, AddItem(Item), AddAmount);
 
 		return FItemAddResult::AddedAll(AddAmount);
 	}
@@ -299,15 +1103,108 @@ UItem* UInventoryComponent::AddItem(UItem* Item)
 		return nullptr;
 
 	// Reconstruct object so that this inventory component is guarenteed to be the owner.
-	UItem* NewItem = NewObject<UItem>(GetOwner(), Item->GetClass());
+	UItem* NewItem = UItemPoolSubsystem::AcquireItem(GetOwner(), Item->GetClass());
 	NewItem->SetQuantity(Item->GetQuantity());
-	NewItem->OwningInventory = this;
-	NewItem->AddToInventory(this);
 
-	Items.Add(NewItem);
-	NewItem->MarkDirtyForReplication();
+	AttachItem(NewItem);
 
 	return NewItem;
 }
 
+void UInventoryComponent::AttachItem(UItem* Item, const FInventoryGridPlacement* Placement)
+{
+	check(Item->GetOuter() == GetOwner());
+
+	Item->GridPosition = FIntPoint(INDEX_NONE, INDEX_NONE);
+	Item->bGridRotated = false;
+
+	if (bUseGrid)
+	{
+		FInventoryGridPlacement FirstFit;
+		if (!Placement && Grid.FindPlacement(Item->GridSize, FirstFit))
+			Placement = &FirstFit;
+
+		// Callers check for room first, so there is always a placement here.
+		if (ensure(Placement))
+		{
+			Item->GridPosition = Placement->Position;
+			Item->bGridRotated = Placement->bRotated;
+			Grid.Occupy(Item->GridPosition, Item->GetGridFootprint());
+		}
+	}
+
+	Item->OwningInventory = this;
+	Item->AddToInventory(this);
+
+	Items.Add(Item);
+	Item->MarkDirtyForReplication();
+
+	NotifyQuantityChanged(Item->GetClass(), Item->GetQuantity());
+}
+
+bool UInventoryComponent::MoveItemInGrid(UItem* Item, const FIntPoint NewPosition, const bool bRotated)
+{
+	if (!GetOwner() || !bUseGrid || !Item)
+		return false;
+
+	// OwningInventory isn't replicated, so clients leave all the checking to the server.
+	if (!GetOwner()->HasAuthority())
+	{
+		ServerMoveItemInGrid(Item, NewPosition, bRotated);
+		return true;
+	}
+
+	if (Item->OwningInventory != this)
+		return false;
+
+	const FIntPoint NewFootprint = FInventoryGrid::GetFootprint(Item->GridSize, bRotated);
+
+	FreeGridCells(Item);
+
+	if (!Grid.Fits(NewPosition, NewFootprint))
+	{
+		Grid.Occupy(Item->GridPosition, Item->GetGridFootprint());
+		return false;
+	}
+
+	Item->GridPosition = NewPosition;
+	Item->bGridRotated = bRotated;
+	Grid.Occupy(NewPosition, NewFootprint);
+
+	Item->MarkDirtyForReplication();
+
+	return true;
+}
+
+void UInventoryComponent::ServerMoveItemInGrid_Implementation(UItem* Item, const FIntPoint NewPosition, const bool bRotated)
+{
+	const APawn* OwnerPawn = Cast<APawn>(GetOwner());
+
+	if (ASurvivalPlayerController* PlayerController = OwnerPawn ? Cast<ASurvivalPlayerController>(OwnerPawn->GetController()) : nullptr)
+	{
+		if (!PlayerController->ConsumeRpcToken(ERateLimitedRpc::RLR_TransferItem))
+			return;
+	}
+
+	MoveItemInGrid(Item, NewPosition, bRotated);
+}
+
+bool UInventoryComponent::ServerMoveItemInGrid_Validate(UItem* Item, const FIntPoint NewPosition, const bool bRotated)
+{
+	// No grid is wider than MaxWidth or taller than configured, a position outside that was never sent by a real client.
+	return NewPosition.X >= 0 && NewPosition.Y >= 0 && NewPosition.X < FInventoryGrid::MaxWidth && NewPosition.Y < GridDimensions.Y;
+}
+
+bool UInventoryComponent::HasGridRoomFor(const UItem* Item) const
+{
+	FInventoryGridPlacement Placement;
+	return !bUseGrid || Grid.FindPlacement(Item->GridSize, Placement);
+}
+
+void UInventoryComponent::FreeGridCells(const UItem* Item)
+{
+	if (bUseGrid && Item)
+		Grid.Free(Item->GridPosition, Item->GetGridFootprint());
+}
+
 #undef LOCTEXT_NAMESPACE
\ No newline at end of file
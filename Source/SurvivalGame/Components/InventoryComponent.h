@@ -4,11 +4,19 @@
 
 #include "CoreMinimal.h"
 #include "Components/ActorComponent.h"
+#include "Components/InventoryGrid.h"
+#include "GameplayTagContainer.h"
 #include "InventoryComponent.generated.h"
 
 // Called to update the UI
 DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnInventoryUpdated);
 
+// Server only, called whenever an item leaves the inventory.
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnItemRemoved, class UItem*);
+
+// Server only, called whenever the inventory's total of a class changes. Delta is negative when it lost some.
+DECLARE_MULTICAST_DELEGATE_TwoParams(FOnItemQuantityChanged, UClass*, int32);
+
 UENUM(BlueprintType)
 enum class EItemAddResult : uint8
 {
@@ -17,6 +25,24 @@ enum class EItemAddResult : uint8
 	IAR_AllItemsAdded UMETA(DisplayName = "All items Added")
 };
 
+UENUM(BlueprintType)
+enum class EInventorySortKey : uint8
+{
+	ISK_Rarity UMETA(DisplayName = "Rarity"),
+	ISK_Weight UMETA(DisplayName = "Weight"),
+	// Keep last, ServerConsolidateAndSort validates against it.
+	ISK_Class UMETA(DisplayName = "Class")
+};
+
+// Who receives an inventory's contents.
+UENUM(BlueprintType)
+enum class EInventoryReplicationPolicy : uint8
+{
+	IRP_Everyone UMETA(DisplayName = "Everyone"),
+	IRP_OwnerOnly UMETA(DisplayName = "Owner Only"),
+	IRP_ViewersOnly UMETA(DisplayName = "Viewers Only")
+};
+
 USTRUCT(BlueprintType)
 struct FItemAddResult
 {
@@ -67,6 +93,64 @@ public:
 	}
 };
 
+USTRUCT(BlueprintType)
+struct FInventoryItemMove
+{
+	GENERATED_BODY()
+
+public:
+
+	FInventoryItemMove() : Item(nullptr), Destination(nullptr), Quantity(0) {};
+	FInventoryItemMove(class UItem* InItem, class UInventoryComponent* InDestination, const int32 InQuantity = 0) : Item(InItem), Destination(InDestination), Quantity(InQuantity) {};
+
+	// Moved out of its OwningInventory.
+	UPROPERTY(BlueprintReadWrite, Category = "Item Move")
+	class UItem* Item;
+
+	UPROPERTY(BlueprintReadWrite, Category = "Item Move")
+	class UInventoryComponent* Destination;
+
+	// 0 moves the whole stack.
+	UPROPERTY(BlueprintReadWrite, Category = "Item Move")
+	int32 Quantity;
+};
+
+USTRUCT(BlueprintType)
+struct FItemQuantity
+{
+	GENERATED_BODY()
+
+public:
+
+	FItemQuantity() : ItemClass(nullptr), Quantity(1) {};
+	FItemQuantity(TSubclassOf<class UItem> InItemClass, const int32 InQuantity) : ItemClass(InItemClass), Quantity(InQuantity) {};
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Item Quantity")
+	TSubclassOf<class UItem> ItemClass;
+
+	// Not limited to one stack.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Item Quantity", meta = (ClampMin = 1))
+	int32 Quantity;
+};
+
+// Carries the item list of an IRP_ViewersOnly inventory. A replicated property goes to every connection the actor
+// does, so the list rides on a subobject that is only replicated on viewers' channels instead.
+UCLASS()
+class SURVIVALGAME_API UInventoryViewerItems : public UObject
+{
+	GENERATED_BODY()
+
+public:
+	virtual bool IsSupportedForNetworking() const override { return true; }
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+	UPROPERTY(ReplicatedUsing = OnRep_Items)
+	TArray<class UItem*> Items;
+
+	UFUNCTION()
+	void OnRep_Items();
+};
+
 UCLASS( ClassGroup=(Custom), meta=(BlueprintSpawnableComponent) )
 class SURVIVALGAME_API UInventoryComponent : public UActorComponent
 {
@@ -89,6 +173,37 @@ public:
 
 	UFUNCTION(BlueprintCallable, Category = "Inventory")
 	bool RemoveItem(class UItem* Item);
+
+	// Merges partial stacks of the same class then sorts by SortKeys, committed as a single replication update.
+	UFUNCTION(BlueprintCallable, Category = "Inventory")
+	void ConsolidateAndSort(const TArray<EInventorySortKey>& SortKeys);
+
+	UFUNCTION(BlueprintCallable, Category = "Inventory")
+	void ConsolidateAndSortDefault();
+
+	/**
+	 * Moves items between inventories as one transaction. Every move is validated against capacity and weight
+	 * on all sides first, then either all of them are applied or none are. Existing item instances are topped
+	 * up or handed over to the destination rather than reconstructed. Server only.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Inventory")
+	static bool MoveItems(const TArray<FInventoryItemMove>& Moves, FText& OutErrorText);
+
+	/**
+	 * Consumes ToConsume and adds ToAdd as one transaction, for crafting and the like. Room for ToAdd is checked
+	 * against the inventory as it will be once ToConsume is gone, and nothing changes unless all of it fits. Server only.
+	 */
+	bool ExchangeItems(const TArray<FItemQuantity>& ToConsume, const TArray<FItemQuantity>& ToAdd, FText& OutErrorText);
+
+	// Grid inventories only. Moves an item to another spot in the grid, optionally rotating it.
+	UFUNCTION(BlueprintCallable, Category = "Inventory")
+	bool MoveItemInGrid(class UItem* Item, const FIntPoint NewPosition, const bool bRotated);
+
+	UFUNCTION(BlueprintPure, Category = "Inventory")
+	FORCEINLINE bool IsGridInventory() const { return bUseGrid; }
+
+	UFUNCTION(BlueprintPure, Category = "Inventory")
+	FORCEINLINE FIntPoint GetGridDimensions() const { return GridDimensions; }
 	
 
 	/* Item navigation */
@@ -103,6 +218,21 @@ public:
 
 	UFUNCTION(BlueprintCallable, Category = "InventoryNavigation")
 	TArray<UItem*>FindItemsByClass(TSubclassOf<class UItem> ItemClass) const;
+
+	// Matches ItemTags the way HasTag does, so Item.Food counts items tagged Item.Food.Meat.
+	UFUNCTION(BlueprintCallable, Category = "InventoryNavigation")
+	int32 GetItemCountByTag(const FGameplayTag Tag) const;
+
+	// Any item with any of Tags, or with bRequireAll, a single item with all of them.
+	UFUNCTION(BlueprintCallable, Category = "InventoryNavigation")
+	bool HasItemWithTags(const FGameplayTagContainer& Tags, const bool bRequireAll = false) const;
+
+	UFUNCTION(BlueprintCallable, Category = "InventoryNavigation")
+	int32 GetItemCountByTagQuery(const FGameplayTagQuery& Query) const;
+
+	// Only looks through Items once the class counts say something matches.
+	UFUNCTION(BlueprintCallable, Category = "InventoryNavigation")
+	UItem* FindItemByTagQuery(const FGameplayTagQuery& Query) const;
 	/* Item navigation */
 
 
@@ -125,6 +255,8 @@ public:
 	UFUNCTION(BlueprintPure, Category = "Inventory")
 	FORCEINLINE TArray<class UItem*> GetItems() const { return Items; }
 
+	FORCEINLINE int32 GetNumItems() const { return Items.Num(); }
+
 	// Server does not need to refresh ui, it just stores the data.
 	UFUNCTION(Client, Reliable)
 	void ClientRefreshInventory();
@@ -132,6 +264,17 @@ public:
 	UPROPERTY(BlueprintAssignable, Category = "Inventory")
 	FOnInventoryUpdated OnInventoryUpdated;
 
+	FOnItemRemoved OnItemRemoved;
+
+	FOnItemQuantityChanged OnItemQuantityChanged;
+
+	// Only used with IRP_ViewersOnly. Viewers receive the item list and contents, everyone else just the owning actor.
+	void AddViewer(class APlayerController* Viewer);
+	void RemoveViewer(class APlayerController* Viewer);
+
+	// Set in the owner's constructor, changing it during play doesn't resend anything already skipped.
+	FORCEINLINE void SetReplicationPolicy(const EInventoryReplicationPolicy NewPolicy) { ReplicationPolicy = NewPolicy; }
+
 protected:
 	// Called when the game starts 
 	virtual void BeginPlay() override;	
@@ -147,7 +290,24 @@ protected:
 	UPROPERTY(ReplicatedUsing = OnRep_Items, VisibleAnywhere, Category = "Inventory")
 	TArray<class UItem*> Items; 
 
+	// OwnerOnly keeps everything, the item list included, on the owning connection. ViewersOnly sends the list and
+	// item contents only to players added with AddViewer, for inventories most players never open.
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Inventory")
+	EInventoryReplicationPolicy ReplicationPolicy;
+
+	// Items also need room for their GridSize footprint, on top of Capacity and WeightCapacity.
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Inventory")
+	bool bUseGrid;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Inventory", meta = (EditCondition = "bUseGrid", ClampMin = 1, ClampMax = 64))
+	FIntPoint GridDimensions;
+
+	// Used by ConsolidateAndSortDefault, earlier keys take priority.
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Inventory")
+	TArray<EInventorySortKey> DefaultSortKeys;
+
 	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+	virtual void PreReplication(IRepChangedPropertyTracker& ChangedPropertyTracker) override;
 	virtual bool ReplicateSubobjects(class UActorChannel* Channel, class FOutBunch* Bunch, FReplicationFlags* RepFlags) override;
 
 private:
@@ -158,9 +318,61 @@ private:
 	UPROPERTY()
 	int32 ReplicatedItemsKey;
 
+	// Replication conditions can't differ per instance, so OwnerOnly inventories send a copy of Items under
+	// COND_OwnerOnly instead and leave Items itself inactive.
+	UPROPERTY(ReplicatedUsing = OnRep_OwnerItems)
+	TArray<class UItem*> OwnerItems;
+
+	int32 OwnerItemsKey;
+
+	UFUNCTION()
+	void OnRep_OwnerItems();
+
+	// ViewersOnly inventories send this instead of Items, created the first time we replicate.
+	UPROPERTY()
+	UInventoryViewerItems* ViewerItems;
+
+	int32 ViewerItemsKey;
+
+	friend class UInventoryViewerItems;
+	void OnRep_ViewerItems(const UInventoryViewerItems* ReceivedItems);
+
+	bool IsOwnerConnection(const class UNetConnection* Connection) const;
+
+	TArray<TWeakObjectPtr<class APlayerController>> Viewers;
+
+	bool IsViewer(const class UNetConnection* Connection) const;
+
+	UFUNCTION(Server, Reliable, WithValidation)
+	void ServerConsolidateAndSort(const TArray<EInventorySortKey>& SortKeys);
+
+	UFUNCTION(Server, Reliable, WithValidation)
+	void ServerMoveItemInGrid(class UItem* Item, const FIntPoint NewPosition, const bool bRotated);
+
+	// Server side occupancy, clients only see each item's GridPosition.
+	FInventoryGrid Grid;
+
+	bool HasGridRoomFor(const class UItem* Item) const;
+
+	void FreeGridCells(const class UItem* Item);
+
 	FItemAddResult TryAddItem_Internal(class UItem* Item);
 
+	// Server side totals per class and per tag index, so the tag queries never walk Items.
+	TMap<UClass*, int32> ClassCounts;
+	TArray<int32> TagCounts;
+
+	// Every change to how much of a class the inventory holds goes through here.
+	void NotifyQuantityChanged(UClass* ItemClass, const int32 Delta);
+
+	// Calls Func with each class held and its total until Func returns false.
+	void ForEachClassCount(TFunctionRef<bool(UClass*, int32)> Func) const;
+
 	// Do not call Items.Add() directly. This function handles replication.
 	UItem* AddItem(class UItem* Item);
 
+	// Adds an item this inventory's owner already outers, without reconstructing it. Grid inventories put it at
+	// Placement, or the first spot it fits if there isn't one.
+	void AttachItem(class UItem* Item, const FInventoryGridPlacement* Placement = nullptr);
+
 };
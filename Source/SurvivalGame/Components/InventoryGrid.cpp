@@ -0,0 +1,132 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Components/InventoryGrid.h"
+
+FInventoryGrid::FInventoryGrid()
+	:Width(0),
+	Height(0),
+	FullRowMask(0)
+{
+}
+
+void FInventoryGrid::Init(const int32 InWidth, const int32 InHeight)
+{
+	Width = FMath::Clamp(InWidth, 0, MaxWidth);
+	Height = FMath::Max(InHeight, 0);
+	FullRowMask = Width > 0 ? GetRowMask(0, Width) : 0;
+
+	Rows.Reset();
+	Rows.SetNumZeroed(Height);
+}
+
+bool FInventoryGrid::IsInBounds(const FIntPoint& Position, const FIntPoint& Size) const
+{
+	if (Size.X <= 0 || Size.Y <= 0 || Position.X < 0 || Position.Y < 0)
+		return false;
+
+	// Positions come from clients, subtracting from the bounds can't overflow where adding to the position could.
+	return Position.X <= Width - Size.X && Position.Y <= Height - Size.Y;
+}
+
+bool FInventoryGrid::Fits(const FIntPoint& Position, const FIntPoint& Size) const
+{
+	if (!IsInBounds(Position, Size))
+		return false;
+
+	const uint64 Mask = GetRowMask(Position.X, Size.X);
+
+	for (int32 Y = Position.Y; Y < Position.Y + Size.Y; ++Y)
+	{
+		if (Rows[Y] & Mask)
+			return false;
+	}
+
+	return true;
+}
+
+bool FInventoryGrid::FindFirstFit(const FIntPoint& Size, FIntPoint& OutPosition) const
+{
+	if (!IsInBounds(FIntPoint::ZeroValue, Size))
+		return false;
+
+	for (int32 Y = 0; Y + Size.Y <= Height; ++Y)
+	{
+		// Columns free in every row the footprint would cover.
+		uint64 FreeColumns = FullRowMask;
+		for (int32 Row = 0; Row < Size.Y && FreeColumns; ++Row)
+		{
+			FreeColumns &= ~Rows[Y + Row];
+		}
+
+		// Bit X survives only if columns X to X + Size.X - 1 are all free.
+		uint64 Starts = FreeColumns;
+		for (int32 Shift = 1; Shift < Size.X && Starts; ++Shift)
+		{
+			Starts &= FreeColumns >> Shift;
+		}
+
+		if (Starts)
+		{
+			OutPosition = FIntPoint((int32)FMath::CountTrailingZeros64(Starts), Y);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool FInventoryGrid::FindPlacement(const FIntPoint& Size, FInventoryGridPlacement& OutPlacement) const
+{
+	if (FindFirstFit(Size, OutPlacement.Position))
+	{
+		OutPlacement.bRotated = false;
+		return true;
+	}
+
+	if (Size.X != Size.Y && FindFirstFit(GetFootprint(Size, true), OutPlacement.Position))
+	{
+		OutPlacement.bRotated = true;
+		return true;
+	}
+
+	return false;
+}
+
+void FInventoryGrid::Occupy(const FIntPoint& Position, const FIntPoint& Size)
+{
+	if (!ensure(Fits(Position, Size)))
+		return;
+
+	const uint64 Mask = GetRowMask(Position.X, Size.X);
+
+	for (int32 Y = Position.Y; Y < Position.Y + Size.Y; ++Y)
+	{
+		Rows[Y] |= Mask;
+	}
+}
+
+void FInventoryGrid::Free(const FIntPoint& Position, const FIntPoint& Size)
+{
+	if (!IsInBounds(Position, Size))
+		return;
+
+	const uint64 Mask = GetRowMask(Position.X, Size.X);
+
+	for (int32 Y = Position.Y; Y < Position.Y + Size.Y; ++Y)
+	{
+		Rows[Y] &= ~Mask;
+	}
+}
+
+int32 FInventoryGrid::GetNumFreeCells() const
+{
+	int32 NumOccupied = 0;
+
+	for (const uint64 Row : Rows)
+	{
+		NumOccupied += (int32)FMath::CountBits(Row);
+	}
+
+	return Width * Height - NumOccupied;
+}
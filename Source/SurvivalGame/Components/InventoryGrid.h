@@ -0,0 +1,66 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// Where an item sits in a grid inventory. Rotated items swap their footprint's width and height.
+struct FInventoryGridPlacement
+{
+	FInventoryGridPlacement()
+		:Position(INDEX_NONE, INDEX_NONE),
+		bRotated(false)
+	{}
+
+	FIntPoint Position;
+	bool bRotated;
+};
+
+/**
+ * Cell occupancy of a grid inventory, one 64 bit word per row. Fit tests are a mask per row of the footprint and
+ * first fit searches AND whole rows together, so nothing loops over individual cells.
+ */
+class SURVIVALGAME_API FInventoryGrid
+{
+public:
+	static constexpr int32 MaxWidth = 64;
+
+	FInventoryGrid();
+
+	void Init(const int32 InWidth, const int32 InHeight);
+
+	FORCEINLINE bool IsValid() const { return Width > 0 && Height > 0; }
+	FORCEINLINE FIntPoint GetDimensions() const { return FIntPoint(Width, Height); }
+
+	bool Fits(const FIntPoint& Position, const FIntPoint& Size) const;
+
+	// Lowest row first, then lowest column.
+	bool FindFirstFit(const FIntPoint& Size, FIntPoint& OutPosition) const;
+
+	// Tries Size as is, then rotated if that's any different.
+	bool FindPlacement(const FIntPoint& Size, FInventoryGridPlacement& OutPlacement) const;
+
+	void Occupy(const FIntPoint& Position, const FIntPoint& Size);
+	void Free(const FIntPoint& Position, const FIntPoint& Size);
+
+	int32 GetNumFreeCells() const;
+
+	static FORCEINLINE FIntPoint GetFootprint(const FIntPoint& Size, const bool bRotated) { return bRotated ? FIntPoint(Size.Y, Size.X) : Size; }
+
+private:
+
+	FORCEINLINE uint64 GetRowMask(const int32 X, const int32 SizeX) const
+	{
+		return (SizeX >= MaxWidth ? ~0ull : ((1ull << SizeX) - 1)) << X;
+	}
+
+	bool IsInBounds(const FIntPoint& Position, const FIntPoint& Size) const;
+
+	int32 Width;
+	int32 Height;
+
+	// Bits past Width, so shifted free masks never run off the right hand edge.
+	uint64 FullRowMask;
+
+	TArray<uint64> Rows;
+};
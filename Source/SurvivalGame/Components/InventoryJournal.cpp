@@ -0,0 +1,269 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Components/InventoryJournal.h"
+#include "HAL/PlatformFileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/CoreDelegates.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+#include "Components/InventoryComponent.h"
+#include "Items/Item.h"
+
+static int32 GInventoryJournal = 0;
+static FAutoConsoleVariableRef CVarInventoryJournal(
+	TEXT("inventory.Journal"),
+	GInventoryJournal,
+	TEXT("Record server side inventory mutations to Saved/InventoryJournal for offline replay."));
+
+static int32 GInventoryJournalCapacity = 1 << 20;
+static FAutoConsoleVariableRef CVarInventoryJournalCapacity(
+	TEXT("inventory.JournalCapacity"),
+	GInventoryJournalCapacity,
+	TEXT("Records kept by the inventory journal before the oldest are overwritten. Read when a journal is opened."));
+
+static int32 GInventoryJournalFlushRecords = 1024;
+static FAutoConsoleVariableRef CVarInventoryJournalFlushRecords(
+	TEXT("inventory.JournalFlushRecords"),
+	GInventoryJournalFlushRecords,
+	TEXT("Records buffered in memory before the inventory journal writes them out."));
+
+FInventoryJournal::~FInventoryJournal()
+{
+	Close();
+}
+
+void FInventoryJournal::Record(const UInventoryComponent* Inventory, const EInventoryJournalOp Op, const UItem* Item, const int32 Quantity)
+{
+	FInventoryJournal& Journal = Get();
+
+	if (!GInventoryJournal)
+	{
+		if (Journal.IsOpen())
+			Journal.Close();
+
+		return;
+	}
+
+	if (!Inventory || (!Journal.IsOpen() && !Journal.Open()))
+		return;
+
+	check(IsInGameThread());
+
+	const float Time = (float)(FPlatformTime::Seconds() - Journal.StartTime);
+
+	FInventoryJournalRecord Record;
+	Record.Time = Time;
+	Record.InventoryId = Journal.GetInventoryId(Inventory, Time);
+	Record.ClassIndex = Journal.GetClassIndex(Item ? Item->GetClass() : nullptr);
+	Record.Op = (uint8)Op;
+	Record.Pad = 0;
+	Record.Quantity = Quantity;
+	Record.ItemId = Journal.GetItemId(Item);
+
+	// Pooled items come back as new items, so a removed item's id is never handed out again.
+	if (Op == EInventoryJournalOp::Remove && Item)
+		Journal.ItemIds.Remove(Item);
+
+	Journal.Append(Record);
+}
+
+FInventoryJournal& FInventoryJournal::Get()
+{
+	static FInventoryJournal Journal;
+	return Journal;
+}
+
+bool FInventoryJournal::Open()
+{
+	const FString Filename = FPaths::ProjectSavedDir() / TEXT("InventoryJournal") / FString::Printf(TEXT("Journal-%s.bin"), *FDateTime::Now().ToString());
+
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	PlatformFile.CreateDirectoryTree(*FPaths::GetPath(Filename));
+
+	FileHandle = PlatformFile.OpenWrite(*Filename);
+
+	if (!FileHandle)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Couldn't open inventory journal %s, turning the journal off"), *Filename);
+		GInventoryJournal = 0;
+		return false;
+	}
+
+	FMemory::Memzero(Header);
+	Header.Magic = FInventoryJournalHeader::JournalMagic;
+	Header.Version = FInventoryJournalHeader::JournalVersion;
+	Header.Capacity = FMath::Max(GInventoryJournalCapacity, 1);
+	Header.RecordsOffset = sizeof(FInventoryJournalHeader);
+	Header.ClassNamesOffset = Header.RecordsOffset + (int64)Header.Capacity * sizeof(FInventoryJournalRecord);
+
+	StartTime = FPlatformTime::Seconds();
+	InventoryIds.Reset();
+	ClassIndices.Reset();
+	ClassNames.Reset();
+	ItemIds.Reset();
+	NextItemId = 1;
+
+	// Index 0 is "no class" for records that don't involve an item.
+	ClassNames.Add(FString());
+
+	PreExitHandle = FCoreDelegates::OnPreExit.AddRaw(this, &FInventoryJournal::Close);
+
+	UE_LOG(LogTemp, Display, TEXT("Recording inventory journal to %s"), *Filename);
+	return true;
+}
+
+void FInventoryJournal::Close()
+{
+	if (!FileHandle)
+		return;
+
+	Flush();
+
+	delete FileHandle;
+	FileHandle = nullptr;
+
+	FCoreDelegates::OnPreExit.Remove(PreExitHandle);
+}
+
+void FInventoryJournal::Append(const FInventoryJournalRecord& Record)
+{
+	PendingRecords.Add(Record);
+
+	if (PendingRecords.Num() >= GInventoryJournalFlushRecords)
+		Flush();
+}
+
+void FInventoryJournal::Flush()
+{
+	if (!FileHandle)
+		return;
+
+	// Records go into the ring at wherever the last flush left off, split in two if they wrap past the end.
+	int32 Written = 0;
+
+	while (Written < PendingRecords.Num())
+	{
+		const int64 Slot = (int64)(Header.NumWritten % (uint64)Header.Capacity);
+		const int32 Count = (int32)FMath::Min<int64>(PendingRecords.Num() - Written, Header.Capacity - Slot);
+
+		FileHandle->Seek(Header.RecordsOffset + Slot * sizeof(FInventoryJournalRecord));
+		FileHandle->Write((const uint8*)&PendingRecords[Written], Count * sizeof(FInventoryJournalRecord));
+
+		Written += Count;
+		Header.NumWritten += Count;
+	}
+
+	PendingRecords.Reset();
+
+	FString ClassNamesBlob = FString::Join(ClassNames, TEXT("\n"));
+	const FTCHARToUTF8 ClassNamesAnsi(*ClassNamesBlob);
+
+	Header.NumClasses = ClassNames.Num();
+	Header.ClassNamesLength = ClassNamesAnsi.Length();
+
+	FileHandle->Seek(Header.ClassNamesOffset);
+	FileHandle->Write((const uint8*)ClassNamesAnsi.Get(), ClassNamesAnsi.Length());
+
+	FileHandle->Seek(0);
+	FileHandle->Write((const uint8*)&Header, sizeof(Header));
+	FileHandle->Flush();
+}
+
+uint32 FInventoryJournal::GetInventoryId(const UInventoryComponent* Inventory, const float Time)
+{
+	if (const uint32* ExistingId = InventoryIds.Find(Inventory))
+		return *ExistingId;
+
+	const uint32 InventoryId = InventoryIds.Num();
+	InventoryIds.Add(Inventory, InventoryId);
+
+	// Replay needs to know what the inventory could hold before anything happens to it.
+	FInventoryJournalRecord Record;
+	FMemory::Memzero(Record);
+	Record.Time = Time;
+	Record.InventoryId = InventoryId;
+
+	Record.Op = (uint8)EInventoryJournalOp::Register;
+	Record.Quantity = Inventory->GetCapacity();
+	Append(Record);
+
+	Record.Op = (uint8)EInventoryJournalOp::WeightCapacity;
+	Record.Quantity = FMath::RoundToInt(Inventory->GetWeightCapacity() * 100.f);
+	Append(Record);
+
+	return InventoryId;
+}
+
+uint16 FInventoryJournal::GetClassIndex(const UClass* ItemClass)
+{
+	if (!ItemClass)
+		return 0;
+
+	if (const uint16* ExistingIndex = ClassIndices.Find(ItemClass))
+		return *ExistingIndex;
+
+	if (ClassNames.Num() > MAX_uint16)
+		return 0;
+
+	const uint16 ClassIndex = ClassNames.Add(ItemClass->GetPathName());
+	ClassIndices.Add(ItemClass, ClassIndex);
+
+	return ClassIndex;
+}
+
+uint32 FInventoryJournal::GetItemId(const UItem* Item)
+{
+	if (!Item)
+		return 0;
+
+	if (const uint32* ExistingId = ItemIds.Find(Item))
+		return *ExistingId;
+
+	return ItemIds.Add(Item, NextItemId++);
+}
+
+bool FInventoryJournal::Load(const FString& Filename, TArray<FInventoryJournalRecord>& OutRecords, TArray<FString>& OutClassNames)
+{
+	TArray<uint8> Data;
+
+	if (!FFileHelper::LoadFileToArray(Data, *Filename))
+		return false;
+
+	if (Data.Num() < sizeof(FInventoryJournalHeader))
+		return false;
+
+	FInventoryJournalHeader LoadedHeader;
+	FMemory::Memcpy(&LoadedHeader, Data.GetData(), sizeof(LoadedHeader));
+
+	if (LoadedHeader.Magic != FInventoryJournalHeader::JournalMagic || LoadedHeader.Version != FInventoryJournalHeader::JournalVersion || LoadedHeader.Capacity <= 0)
+		return false;
+
+	// Anything the header points at has to be in the file, a truncated or corrupt journal is refused rather than read past.
+	if (LoadedHeader.RecordsOffset < (int64)sizeof(FInventoryJournalHeader) || LoadedHeader.RecordsOffset + (int64)LoadedHeader.Capacity * sizeof(FInventoryJournalRecord) > Data.Num())
+		return false;
+
+	if (LoadedHeader.ClassNamesOffset < 0 || LoadedHeader.ClassNamesLength < 0 || LoadedHeader.ClassNamesOffset + LoadedHeader.ClassNamesLength > Data.Num())
+		return false;
+
+	const FInventoryJournalRecord* Records = (const FInventoryJournalRecord*)(Data.GetData() + LoadedHeader.RecordsOffset);
+	const int32 NumRecords = (int32)FMath::Min<uint64>(LoadedHeader.NumWritten, LoadedHeader.Capacity);
+	const int32 FirstSlot = LoadedHeader.NumWritten > (uint64)LoadedHeader.Capacity ? (int32)(LoadedHeader.NumWritten % LoadedHeader.Capacity) : 0;
+
+	OutRecords.Reset(NumRecords);
+
+	for (int32 Index = 0; Index < NumRecords; ++Index)
+	{
+		OutRecords.Add(Records[(FirstSlot + Index) % LoadedHeader.Capacity]);
+	}
+
+	const FUTF8ToTCHAR ClassNamesBlob((const ANSICHAR*)(Data.GetData() + LoadedHeader.ClassNamesOffset), LoadedHeader.ClassNamesLength);
+	FString(ClassNamesBlob.Length(), ClassNamesBlob.Get()).ParseIntoArray(OutClassNames, TEXT("\n"), false);
+
+	// An empty blob parses to nothing rather than the single "no class" entry.
+	if (OutClassNames.Num() == 0)
+		OutClassNames.Add(FString());
+
+	return OutClassNames.Num() == LoadedHeader.NumClasses;
+}
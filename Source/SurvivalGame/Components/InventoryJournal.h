@@ -0,0 +1,113 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/ObjectKey.h"
+
+class IFileHandle;
+class UInventoryComponent;
+class UItem;
+
+enum class EInventoryJournalOp : uint8
+{
+	// First time an inventory shows up, Quantity holds its capacity.
+	Register,
+	// Quantity holds the weight capacity in hundredths.
+	WeightCapacity,
+	Add,
+	Consume,
+	// Quantity is what the item held when removed, 0 when a consume emptied it.
+	Remove,
+	// Quantity is 1 for equip, 0 for unequip.
+	Equip,
+	// Only marks the drop, the consume it does is journaled on its own.
+	Drop
+};
+
+/**
+ * On disk layout of an inventory journal. The file is a fixed size ring of records, once full the oldest records
+ * are overwritten.
+ *
+ * [Header][Records x Capacity][ClassNames]
+ *
+ * ClassNames is a newline separated ANSI list of item class paths, rewritten whenever the journal is flushed.
+ */
+struct FInventoryJournalHeader
+{
+	static constexpr uint32 JournalMagic = 0x4E4A5649; // 'IVJN'
+	static constexpr uint32 JournalVersion = 2;
+
+	uint32 Magic;
+	uint32 Version;
+	int32 Capacity;
+	int32 NumClasses;
+	uint64 NumWritten;
+	int64 RecordsOffset;
+	int64 ClassNamesOffset;
+	int64 ClassNamesLength;
+};
+
+struct FInventoryJournalRecord
+{
+	// Seconds since the journal was opened.
+	float Time;
+	uint32 InventoryId;
+	uint16 ClassIndex;
+	uint8 Op;
+	uint8 Pad;
+	int32 Quantity;
+	// Identifies the item across records until it is removed, 0 for records that don't involve an item.
+	uint32 ItemId;
+};
+
+static_assert(sizeof(FInventoryJournalRecord) == 20, "Journal records are written raw, keep them tightly packed.");
+
+/**
+ * Records server side inventory mutations while inventory.Journal is set, so a real session's workload can be
+ * replayed offline by the InventoryReplay commandlet. Mutations are recorded once they've happened, with the
+ * quantity they actually moved. Game thread only.
+ */
+class SURVIVALGAME_API FInventoryJournal
+{
+public:
+	~FInventoryJournal();
+
+	// Does nothing unless inventory.Journal is set.
+	static void Record(const UInventoryComponent* Inventory, const EInventoryJournalOp Op, const UItem* Item = nullptr, const int32 Quantity = 0);
+
+	static FInventoryJournal& Get();
+
+	void Close();
+
+	bool IsOpen() const { return FileHandle != nullptr; }
+
+	// Reads a whole journal back in order, oldest record first.
+	static bool Load(const FString& Filename, TArray<FInventoryJournalRecord>& OutRecords, TArray<FString>& OutClassNames);
+
+private:
+
+	bool Open();
+	void Flush();
+	void Append(const FInventoryJournalRecord& Record);
+
+	uint32 GetInventoryId(const UInventoryComponent* Inventory, const float Time);
+	uint16 GetClassIndex(const UClass* ItemClass);
+	uint32 GetItemId(const UItem* Item);
+
+	IFileHandle* FileHandle = nullptr;
+	FInventoryJournalHeader Header;
+
+	double StartTime = 0.0;
+
+	// Not yet written to the file.
+	TArray<FInventoryJournalRecord> PendingRecords;
+
+	TMap<FObjectKey, uint32> InventoryIds;
+	TMap<FObjectKey, uint16> ClassIndices;
+	TMap<FObjectKey, uint32> ItemIds;
+	uint32 NextItemId = 1;
+	TArray<FString> ClassNames;
+
+	FDelegateHandle PreExitHandle;
+};
@@ -0,0 +1,477 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Components/StashComponent.h"
+#include "Net/UnrealNetwork.h"
+#include "Engine/ActorChannel.h"
+#include "Engine/NetConnection.h"
+#include "GameFramework/Pawn.h"
+
+#include "Items/Item.h"
+#include "Items/EquippableItem.h"
+#include "Items/ItemPoolSubsystem.h"
+#include "Player/SurvivalCharacter.h"
+#include "Player/SurvivalPlayerController.h"
+
+#define LOCTEXT_NAMESPACE "Stash"
+
+void FStashPage::PostReplicatedAdd(const FStashPageArray& InArraySerializer)
+{
+	if (InArraySerializer.Owner)
+		InArraySerializer.Owner->OnPageReplicated(*this);
+}
+
+void FStashPage::PostReplicatedChange(const FStashPageArray& InArraySerializer)
+{
+	if (InArraySerializer.Owner)
+		InArraySerializer.Owner->OnPageReplicated(*this);
+}
+
+void FStashPage::PreReplicatedRemove(const FStashPageArray& InArraySerializer)
+{
+	if (InArraySerializer.Owner)
+		InArraySerializer.Owner->OnPageUpdated.Broadcast(PageIndex);
+}
+
+UStashComponent::UStashComponent()
+	:Capacity(10000),
+	PageSize(100),
+	WeightCapacity(0.f),
+	MaxOpenPages(4),
+	CurrentWeight(0.f),
+	NumItems(0),
+	FirstPageWithSpace(0)
+{
+	SetIsReplicated(true);
+
+	OpenPages.Owner = this;
+}
+
+void UStashComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (!GetOwner()->HasAuthority())
+		return;
+
+	StoredPages.SetNum(GetNumPages());
+
+	for (int32 i = 0; i < StoredPages.Num(); ++i)
+	{
+		StoredPages[i].PageIndex = i;
+	}
+}
+
+FItemAddResult UStashComponent::TryAddItemOfClass(TSubclassOf<UItem> ItemClass, const int32 Quantity)
+{
+	if (!GetOwner()->HasAuthority())
+		return FItemAddResult::AddedNone(-1, LOCTEXT("IsNotServerText", "Clients cannot add items."));
+
+	if (!ItemClass || Quantity <= 0)
+		return FItemAddResult::AddedNone(Quantity, LOCTEXT("InvalidItemText", "Nothing to add."));
+
+	const UItem* ItemDefaults = ItemClass->GetDefaultObject<UItem>();
+	const int32 MaxStackSize = ItemDefaults->bIsStackable ? ItemDefaults->MaxStackSize : 1;
+
+	int32 Remaining = Quantity;
+
+	if (WeightCapacity > 0.f && !FMath::IsNearlyZero(ItemDefaults->Weight))
+		Remaining = FMath::Min(Remaining, FMath::FloorToInt((WeightCapacity - CurrentWeight) / ItemDefaults->Weight));
+
+	if (Remaining <= 0)
+		return FItemAddResult::AddedNone(Quantity, LOCTEXT("StashTooMuchWeightText", "Stash is too heavy."));
+
+	FStashClassAggregate& Aggregate = ClassAggregates.FindOrAdd(ItemClass);
+
+	// Top up partial stacks first, they're all on hand in the aggregate.
+	for (UItem* Stack : Aggregate.Stacks)
+	{
+		if (Remaining <= 0)
+			break;
+
+		const int32 AddAmount = FMath::Min(Remaining, MaxStackSize - Stack->GetQuantity());
+		if (AddAmount <= 0)
+			continue;
+
+		Stack->SetQuantity(Stack->GetQuantity() + AddAmount);
+		Remaining -= AddAmount;
+
+		MarkPageDirty(ItemPages.FindChecked(Stack));
+	}
+
+	while (Remaining > 0 && NumItems < Capacity)
+	{
+		while (StoredPages.IsValidIndex(FirstPageWithSpace) && StoredPages[FirstPageWithSpace].Items.Num() >= PageSize)
+			++FirstPageWithSpace;
+
+		if (!StoredPages.IsValidIndex(FirstPageWithSpace))
+			break;
+
+		const int32 StackQuantity = FMath::Min(Remaining, MaxStackSize);
+
+		UItem* NewStack = UItemPoolSubsystem::AcquireItem(GetOwner(), ItemClass);
+		NewStack->SetQuantity(StackQuantity);
+
+		StoredPages[FirstPageWithSpace].Items.Add(NewStack);
+		ItemPages.Add(NewStack, FirstPageWithSpace);
+		Aggregate.Stacks.Add(NewStack);
+		++NumItems;
+
+		Remaining -= StackQuantity;
+
+		MarkPageDirty(FirstPageWithSpace);
+	}
+
+	const int32 AddedAmount = Quantity - Remaining;
+
+	Aggregate.Quantity += AddedAmount;
+	CurrentWeight += AddedAmount * ItemDefaults->Weight;
+
+	if (AddedAmount <= 0)
+		return FItemAddResult::AddedNone(Quantity, LOCTEXT("StashFullText", "Stash is full."));
+
+	if (AddedAmount < Quantity)
+		return FItemAddResult::AddedSome(Quantity, AddedAmount, FText::Format(LOCTEXT("StashPartialText", "Couldn't fit all {ItemName} in the stash."), ItemDefaults->ItemDisplayName));
+
+	return FItemAddResult::AddedAll(Quantity);
+}
+
+int32 UStashComponent::ConsumeItem(UItem* Item, const int32 Quantity)
+{
+	if (!GetOwner()->HasAuthority() || !Item || !ItemPages.Contains(Item))
+		return 0;
+
+	const int32 RemoveQuantity = FMath::Clamp(Quantity, 0, Item->GetQuantity());
+
+	if (RemoveQuantity >= Item->GetQuantity())
+	{
+		RemoveItem(Item);
+		return RemoveQuantity;
+	}
+
+	Item->SetQuantity(Item->GetQuantity() - RemoveQuantity);
+
+	ClassAggregates.FindChecked(Item->GetClass()).Quantity -= RemoveQuantity;
+	CurrentWeight = FMath::Max(CurrentWeight - RemoveQuantity * Item->Weight, 0.f);
+
+	MarkPageDirty(ItemPages.FindChecked(Item));
+
+	return RemoveQuantity;
+}
+
+bool UStashComponent::RemoveItem(UItem* Item)
+{
+	if (!GetOwner()->HasAuthority() || !Item)
+		return false;
+
+	int32 PageIndex = INDEX_NONE;
+	if (!ItemPages.RemoveAndCopyValue(Item, PageIndex))
+		return false;
+
+	StoredPages[PageIndex].Items.RemoveSingle(Item);
+	FirstPageWithSpace = FMath::Min(FirstPageWithSpace, PageIndex);
+	--NumItems;
+
+	FStashClassAggregate& Aggregate = ClassAggregates.FindChecked(Item->GetClass());
+	Aggregate.Stacks.RemoveSingleSwap(Item);
+	Aggregate.Quantity -= Item->GetQuantity();
+
+	if (Aggregate.Stacks.Num() == 0)
+		ClassAggregates.Remove(Item->GetClass());
+
+	CurrentWeight = FMath::Max(CurrentWeight - Item->GetStackWeight(), 0.f);
+
+	MarkPageDirty(PageIndex);
+
+	return true;
+}
+
+bool UStashComponent::HasItem(TSubclassOf<UItem> ItemClass, const int32 Quantity) const
+{
+	return GetItemCount(ItemClass) >= Quantity;
+}
+
+int32 UStashComponent::GetItemCount(TSubclassOf<UItem> ItemClass) const
+{
+	const FStashClassAggregate* Aggregate = ClassAggregates.Find(ItemClass);
+	return Aggregate ? Aggregate->Quantity : 0;
+}
+
+UItem* UStashComponent::FindItemByClass(TSubclassOf<UItem> ItemClass) const
+{
+	const FStashClassAggregate* Aggregate = ClassAggregates.Find(ItemClass);
+	return Aggregate && Aggregate->Stacks.Num() > 0 ? Aggregate->Stacks[0] : nullptr;
+}
+
+void UStashComponent::DepositItem(UItem* Item)
+{
+	if (!GetOwner()->HasAuthority())
+	{
+		ServerDepositItem(Item);
+		return;
+	}
+
+	UInventoryComponent* Inventory = GetOwnerInventory();
+	if (!Inventory || !Item || Item->OwningInventory != Inventory || Item->GetQuantity() <= 0)
+		return;
+
+	UEquippableItem* EquippableItem = Cast<UEquippableItem>(Item);
+	if (EquippableItem && EquippableItem->IsEquipped())
+		return;
+
+	if (NumItems >= Capacity || (WeightCapacity > 0.f && CurrentWeight + Item->GetStackWeight() > WeightCapacity))
+		return;
+
+	// The item itself moves across, copying it by class would lose whatever state this instance carries.
+	if (Inventory->RemoveItem(Item))
+		StoreItem(Item);
+}
+
+void UStashComponent::StoreItem(UItem* Item)
+{
+	while (StoredPages.IsValidIndex(FirstPageWithSpace) && StoredPages[FirstPageWithSpace].Items.Num() >= PageSize)
+		++FirstPageWithSpace;
+
+	if (!ensure(StoredPages.IsValidIndex(FirstPageWithSpace)))
+		return;
+
+	StoredPages[FirstPageWithSpace].Items.Add(Item);
+	ItemPages.Add(Item, FirstPageWithSpace);
+	++NumItems;
+
+	FStashClassAggregate& Aggregate = ClassAggregates.FindOrAdd(Item->GetClass());
+	Aggregate.Stacks.Add(Item);
+	Aggregate.Quantity += Item->GetQuantity();
+
+	CurrentWeight += Item->GetStackWeight();
+
+	MarkPageDirty(FirstPageWithSpace);
+}
+
+void UStashComponent::WithdrawItem(UItem* Item)
+{
+	if (!GetOwner()->HasAuthority())
+	{
+		ServerWithdrawItem(Item);
+		return;
+	}
+
+	UInventoryComponent* Inventory = GetOwnerInventory();
+	if (!Inventory || !Item || !ItemPages.Contains(Item))
+		return;
+
+	const FItemAddResult AddResult = Inventory->TryAddItemOfClass(Item->GetClass(), Item->GetQuantity());
+
+	if (AddResult.ActualAmountGiven > 0)
+		ConsumeItem(Item, AddResult.ActualAmountGiven);
+}
+
+void UStashComponent::OpenPage(const int32 PageIndex)
+{
+	if (!GetOwner()->HasAuthority())
+	{
+		ServerOpenPage(PageIndex);
+		return;
+	}
+
+	if (!StoredPages.IsValidIndex(PageIndex) || OpenPages.Pages.Num() >= MaxOpenPages)
+		return;
+
+	if (OpenPages.Pages.ContainsByPredicate([PageIndex](const FStashPage& Page) { return Page.PageIndex == PageIndex; }))
+		return;
+
+	FStashPage& Page = OpenPages.Pages.AddDefaulted_GetRef();
+	Page.PageIndex = PageIndex;
+	Page.Items = StoredPages[PageIndex].Items;
+	Page.ChangeKey = StoredPages[PageIndex].ChangeKey;
+
+	OpenPages.MarkItemDirty(Page);
+}
+
+void UStashComponent::ClosePage(const int32 PageIndex)
+{
+	if (!GetOwner()->HasAuthority())
+	{
+		ServerClosePage(PageIndex);
+		return;
+	}
+
+	if (OpenPages.Pages.RemoveAll([PageIndex](const FStashPage& Page) { return Page.PageIndex == PageIndex; }) > 0)
+		OpenPages.MarkArrayDirty();
+}
+
+bool UStashComponent::GetPageItems(const int32 PageIndex, TArray<UItem*>& OutItems) const
+{
+	if (GetOwner()->HasAuthority() && StoredPages.IsValidIndex(PageIndex))
+	{
+		OutItems = StoredPages[PageIndex].Items;
+		return true;
+	}
+
+	for (const FStashPage& Page : OpenPages.Pages)
+	{
+		if (Page.PageIndex == PageIndex)
+		{
+			OutItems = Page.Items;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void UStashComponent::OnPageReplicated(const FStashPage& Page)
+{
+	TArray<UItem*>& PageItems = ClientPageItems.FindOrAdd(Page.PageIndex);
+
+	for (UItem* Item : Page.Items)
+	{
+		if (Item)
+			++ClientItemPageCounts.FindOrAdd(Item);
+	}
+
+	for (UItem* Item : PageItems)
+	{
+		int32& PageCount = ClientItemPageCounts.FindChecked(Item);
+
+		if (--PageCount <= 0)
+			ClientItemPageCounts.Remove(Item);
+	}
+
+	PageItems.Reset();
+
+	for (UItem* Item : Page.Items)
+	{
+		if (Item)
+			PageItems.Add(Item);
+	}
+
+	OnPageUpdated.Broadcast(Page.PageIndex);
+}
+
+void UStashComponent::MarkPageDirty(const int32 PageIndex)
+{
+	FStashPage& StoredPage = StoredPages[PageIndex];
+	++StoredPage.ChangeKey;
+
+	for (FStashPage& Page : OpenPages.Pages)
+	{
+		if (Page.PageIndex == PageIndex)
+		{
+			Page.Items = StoredPage.Items;
+			Page.ChangeKey = StoredPage.ChangeKey;
+			OpenPages.MarkItemDirty(Page);
+			break;
+		}
+	}
+}
+
+UInventoryComponent* UStashComponent::GetOwnerInventory() const
+{
+	const ASurvivalCharacter* Character = Cast<ASurvivalCharacter>(GetOwner());
+	return Character ? Character->PlayerInventory : nullptr;
+}
+
+// The stash's own RPCs are limited through the owning pawn's controller like the inventory's.
+static bool ConsumeStashRpcToken(const UStashComponent* Stash, const ERateLimitedRpc Rpc)
+{
+	const APawn* OwnerPawn = Cast<APawn>(Stash->GetOwner());
+
+	if (ASurvivalPlayerController* PlayerController = OwnerPawn ? Cast<ASurvivalPlayerController>(OwnerPawn->GetController()) : nullptr)
+		return PlayerController->ConsumeRpcToken(Rpc);
+
+	return true;
+}
+
+static bool IsStashOwnerAbusingRpcs(const UStashComponent* Stash)
+{
+	const APawn* OwnerPawn = Cast<APawn>(Stash->GetOwner());
+	const ASurvivalPlayerController* PlayerController = OwnerPawn ? Cast<ASurvivalPlayerController>(OwnerPawn->GetController()) : nullptr;
+
+	return PlayerController && PlayerController->IsAbusingRpcs();
+}
+
+void UStashComponent::ServerOpenPage_Implementation(const int32 PageIndex)
+{
+	if (ConsumeStashRpcToken(this, ERateLimitedRpc::RLR_StashPage))
+		OpenPage(PageIndex);
+}
+
+void UStashComponent::ServerClosePage_Implementation(const int32 PageIndex)
+{
+	if (ConsumeStashRpcToken(this, ERateLimitedRpc::RLR_StashPage))
+		ClosePage(PageIndex);
+}
+
+void UStashComponent::ServerDepositItem_Implementation(UItem* Item)
+{
+	if (ConsumeStashRpcToken(this, ERateLimitedRpc::RLR_TransferItem))
+		DepositItem(Item);
+}
+
+void UStashComponent::ServerWithdrawItem_Implementation(UItem* Item)
+{
+	if (ConsumeStashRpcToken(this, ERateLimitedRpc::RLR_TransferItem))
+		WithdrawItem(Item);
+}
+
+bool UStashComponent::ServerOpenPage_Validate(const int32 PageIndex)
+{
+	return !IsStashOwnerAbusingRpcs(this);
+}
+
+bool UStashComponent::ServerClosePage_Validate(const int32 PageIndex)
+{
+	return !IsStashOwnerAbusingRpcs(this);
+}
+
+bool UStashComponent::ServerDepositItem_Validate(UItem* Item)
+{
+	return !IsStashOwnerAbusingRpcs(this);
+}
+
+bool UStashComponent::ServerWithdrawItem_Validate(UItem* Item)
+{
+	return !IsStashOwnerAbusingRpcs(this);
+}
+
+void UStashComponent::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME_CONDITION(UStashComponent, OpenPages, COND_OwnerOnly);
+}
+
+bool UStashComponent::ReplicateSubobjects(UActorChannel* Channel, FOutBunch* Bunch, FReplicationFlags* RepFlags)
+{
+	bool bWroteToActorChannel = Super::ReplicateSubobjects(Channel, Bunch, RepFlags);
+
+	if (!Channel->Connection || GetOwner()->GetNetConnection() != Channel->Connection)
+		return bWroteToActorChannel;
+
+	if (SentPageConnection != Channel->Connection)
+	{
+		SentPageChangeKeys.Reset();
+		SentPageConnection = Channel->Connection;
+	}
+
+	for (const FStashPage& Page : OpenPages.Pages)
+	{
+		// Pages that haven't changed since this connection last saw them can skip walking their items.
+		int32& SentChangeKey = SentPageChangeKeys.FindOrAdd(Page.PageIndex, INDEX_NONE);
+		if (SentChangeKey == Page.ChangeKey)
+			continue;
+
+		SentChangeKey = Page.ChangeKey;
+
+		for (UItem* Item : Page.Items)
+		{
+			if (Item && Channel->KeyNeedsToReplicate(Item->GetUniqueID(), Item->RepKey))
+				bWroteToActorChannel |= Channel->ReplicateSubobject(Item, *Bunch, *RepFlags);
+		}
+	}
+
+	return bWroteToActorChannel;
+}
+
+#undef LOCTEXT_NAMESPACE
@@ -0,0 +1,217 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "Net/Serialization/FastArraySerializer.h"
+#include "Components/InventoryComponent.h"
+#include "StashComponent.generated.h"
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnStashPageUpdated, int32, PageIndex);
+
+// One page of a stash. The fast array's replication key doubles as the page's change key on clients.
+USTRUCT()
+struct FStashPage : public FFastArraySerializerItem
+{
+	GENERATED_BODY()
+
+public:
+	FStashPage()
+		:PageIndex(INDEX_NONE),
+		ChangeKey(0)
+	{}
+
+	UPROPERTY()
+	int32 PageIndex;
+
+	UPROPERTY()
+	TArray<class UItem*> Items;
+
+	// Server only, bumped whenever the page's item list or an item on it changes.
+	UPROPERTY(NotReplicated)
+	int32 ChangeKey;
+
+	void PostReplicatedAdd(const struct FStashPageArray& InArraySerializer);
+	void PostReplicatedChange(const struct FStashPageArray& InArraySerializer);
+	void PreReplicatedRemove(const struct FStashPageArray& InArraySerializer);
+};
+
+// The pages the owning client has open.
+USTRUCT()
+struct FStashPageArray : public FFastArraySerializer
+{
+	GENERATED_BODY()
+
+public:
+	FStashPageArray()
+		:Owner(nullptr)
+	{}
+
+	UPROPERTY()
+	TArray<FStashPage> Pages;
+
+	class UStashComponent* Owner;
+
+	bool NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms)
+	{
+		return FFastArraySerializer::FastArrayDeltaSerialize<FStashPage, FStashPageArray>(Pages, DeltaParms, *this);
+	}
+};
+
+template<>
+struct TStructOpsTypeTraits<FStashPageArray> : public TStructOpsTypeTraitsBase2<FStashPageArray>
+{
+	enum
+	{
+		WithNetDeltaSerializer = true,
+	};
+};
+
+/**
+ * Bank sized storage split into pages. The server holds every page, the owning client only receives the pages it has
+ * open. Counts and weight come from per class aggregates kept up to date on every change, so nothing on the server
+ * walks the whole stash. Must be on a pawn, its controller opens pages and moves items in and out.
+ */
+UCLASS(ClassGroup = (Custom), meta = (BlueprintSpawnableComponent))
+class SURVIVALGAME_API UStashComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	UStashComponent();
+
+	/* Server */
+	UFUNCTION(BlueprintCallable, Category = "Stash")
+	FItemAddResult TryAddItemOfClass(TSubclassOf<class UItem> ItemClass, const int32 Quantity);
+
+	int32 ConsumeItem(class UItem* Item, const int32 Quantity);
+
+	UFUNCTION(BlueprintCallable, Category = "Stash")
+	bool RemoveItem(class UItem* Item);
+
+	UFUNCTION(BlueprintCallable, Category = "Stash")
+	bool HasItem(TSubclassOf<class UItem> ItemClass, const int32 Quantity = 1) const;
+
+	UFUNCTION(BlueprintCallable, Category = "Stash")
+	int32 GetItemCount(TSubclassOf<class UItem> ItemClass) const;
+
+	UFUNCTION(BlueprintCallable, Category = "Stash")
+	class UItem* FindItemByClass(TSubclassOf<class UItem> ItemClass) const;
+
+	UFUNCTION(BlueprintPure, Category = "Stash")
+	FORCEINLINE float GetCurrentWeight() const { return CurrentWeight; }
+
+	UFUNCTION(BlueprintPure, Category = "Stash")
+	FORCEINLINE int32 GetNumItems() const { return NumItems; }
+	/* Server */
+
+	// Moves Item itself from the owning pawn's inventory into the stash if there's room for all of it. Equipped items
+	// have to be unequipped first.
+	UFUNCTION(BlueprintCallable, Category = "Stash")
+	void DepositItem(class UItem* Item);
+
+	// Moves Item from the stash into the owning pawn's inventory, as much of it as fits.
+	UFUNCTION(BlueprintCallable, Category = "Stash")
+	void WithdrawItem(class UItem* Item);
+
+	// Starts or stops replicating a page to the owning client.
+	UFUNCTION(BlueprintCallable, Category = "Stash")
+	void OpenPage(const int32 PageIndex);
+
+	UFUNCTION(BlueprintCallable, Category = "Stash")
+	void ClosePage(const int32 PageIndex);
+
+	// Client side only has the pages it has open, returns false for any other.
+	UFUNCTION(BlueprintCallable, Category = "Stash")
+	bool GetPageItems(const int32 PageIndex, TArray<class UItem*>& OutItems) const;
+
+	UFUNCTION(BlueprintPure, Category = "Stash")
+	FORCEINLINE int32 GetNumPages() const { return FMath::DivideAndRoundUp(Capacity, PageSize); }
+
+	UFUNCTION(BlueprintPure, Category = "Stash")
+	FORCEINLINE int32 GetCapacity() const { return Capacity; }
+
+	UPROPERTY(BlueprintAssignable, Category = "Stash")
+	FOnStashPageUpdated OnPageUpdated;
+
+	void OnPageReplicated(const FStashPage& Page);
+
+protected:
+	virtual void BeginPlay() override;
+
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+	virtual bool ReplicateSubobjects(class UActorChannel* Channel, class FOutBunch* Bunch, FReplicationFlags* RepFlags) override;
+
+	// Stacks the stash can hold, across every page.
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Stash", meta = (ClampMin = 1))
+	int32 Capacity;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Stash", meta = (ClampMin = 1))
+	int32 PageSize;
+
+	// 0 for no weight limit.
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Stash")
+	float WeightCapacity;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Stash", meta = (ClampMin = 1))
+	int32 MaxOpenPages;
+
+private:
+
+	UFUNCTION(Server, Reliable, WithValidation)
+	void ServerOpenPage(const int32 PageIndex);
+
+	UFUNCTION(Server, Reliable, WithValidation)
+	void ServerClosePage(const int32 PageIndex);
+
+	UFUNCTION(Server, Reliable, WithValidation)
+	void ServerDepositItem(class UItem* Item);
+
+	UFUNCTION(Server, Reliable, WithValidation)
+	void ServerWithdrawItem(class UItem* Item);
+
+	class UInventoryComponent* GetOwnerInventory() const;
+
+	// Files an existing item on the first page with a free slot. Callers check there's room.
+	void StoreItem(class UItem* Item);
+
+	// Server side copy of every page, open or not.
+	UPROPERTY()
+	TArray<FStashPage> StoredPages;
+
+	UPROPERTY(Replicated)
+	FStashPageArray OpenPages;
+
+	void MarkPageDirty(const int32 PageIndex);
+
+	struct FStashClassAggregate
+	{
+		FStashClassAggregate() : Quantity(0) {}
+
+		int32 Quantity;
+		TArray<class UItem*> Stacks;
+	};
+
+	TMap<UClass*, FStashClassAggregate> ClassAggregates;
+	TMap<class UItem*, int32> ItemPages;
+
+	float CurrentWeight;
+	int32 NumItems;
+
+	// No page before this one has a free slot.
+	int32 FirstPageWithSpace;
+
+	// Change keys of the open pages as the owning connection last got them. Kept apart from the channel's keys, which
+	// are object ids, so a page can't be mistaken for an item.
+	TMap<int32, int32> SentPageChangeKeys;
+	TWeakObjectPtr<class UNetConnection> SentPageConnection;
+
+	// Client side, how many received page lists each item is on. Items are kept alive while any page lists them, so a
+	// page that is closed and opened again can still resolve them, and dropped once the last list replicates without them.
+	UPROPERTY(Transient)
+	TMap<class UItem*, int32> ClientItemPageCounts;
+
+	// Client side, each page's items as last received, open or not.
+	TMap<int32, TArray<class UItem*>> ClientPageItems;
+};
@@ -0,0 +1,180 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Framework/LoadTestBot.h"
+#include "GameFramework/Controller.h"
+#include "EngineUtils.h"
+
+#include "Player/SurvivalCharacter.h"
+#include "Components/InventoryComponent.h"
+#include "Components/InteractionComponent.h"
+#include "Items/Item.h"
+#include "Items/EquippableItem.h"
+#include "World/Pickup.h"
+#include "World/PickupSubsystem.h"
+
+ULoadTestBot::ULoadTestBot()
+	:ActionInterval(1.f, 3.f),
+	SearchRadius(3000.f),
+	TakeChance(0.5f),
+	DropChance(0.2f),
+	State(ELoadTestBotState::LBS_Idle),
+	StateTime(0.f)
+{
+}
+
+void ULoadTestBot::TickBot(AController* Controller, const float DeltaTime)
+{
+	ASurvivalCharacter* Character = Controller ? Cast<ASurvivalCharacter>(Controller->GetPawn()) : nullptr;
+
+	if (!Character)
+		return;
+
+	StateTime -= DeltaTime;
+
+	APickup* Pickup = TargetPickup.Get();
+
+	if (State != ELoadTestBotState::LBS_Idle && (!Pickup || Pickup->IsHidden()))
+	{
+		if (State == ELoadTestBotState::LBS_Interact)
+			Character->EndInteract();
+
+		State = ELoadTestBotState::LBS_Idle;
+		Pickup = nullptr;
+	}
+
+	switch (State)
+	{
+	case ELoadTestBotState::LBS_Idle:
+		if (StateTime <= 0.f)
+			ChooseAction(Character);
+		break;
+
+	case ELoadTestBotState::LBS_Seek:
+	{
+		const FVector ToPickup = Pickup->GetActorLocation() - Character->GetActorLocation();
+
+		// Give up on pickups we can't reach, e.g. stuck behind a wall.
+		if (StateTime <= 0.f)
+		{
+			State = ELoadTestBotState::LBS_Idle;
+		}
+		else if (ToPickup.Size2D() > 150.f)
+		{
+			Character->AddMovementInput(ToPickup.GetSafeNormal2D());
+		}
+		else
+		{
+			// The character's interaction check needs a tick to focus what we're looking at.
+			LookAt(Controller, Pickup->GetActorLocation());
+			State = ELoadTestBotState::LBS_Aim;
+			StateTime = 0.1f;
+		}
+		break;
+	}
+
+	case ELoadTestBotState::LBS_Aim:
+		LookAt(Controller, Pickup->GetActorLocation());
+
+		if (StateTime <= 0.f)
+		{
+			const UInteractionComponent* Interaction = Pickup->FindComponentByClass<UInteractionComponent>();
+
+			Character->BeginInteract();
+			State = ELoadTestBotState::LBS_Interact;
+			StateTime = (Interaction ? Interaction->InteractionTime : 0.f) + 0.2f;
+		}
+		break;
+
+	case ELoadTestBotState::LBS_Interact:
+		LookAt(Controller, Pickup->GetActorLocation());
+
+		if (StateTime <= 0.f)
+		{
+			Character->EndInteract();
+			State = ELoadTestBotState::LBS_Idle;
+		}
+		break;
+	}
+}
+
+void ULoadTestBot::ChooseAction(ASurvivalCharacter* Character)
+{
+	StateTime = FMath::FRandRange(ActionInterval.X, ActionInterval.Y);
+
+	const float Roll = FMath::FRand();
+	const TArray<UItem*> Items = Character->PlayerInventory ? Character->PlayerInventory->GetItems() : TArray<UItem*>();
+
+	if (Roll < TakeChance || Items.Num() == 0)
+	{
+		if (APickup* Pickup = FindPickup(Character))
+		{
+			TargetPickup = Pickup;
+			State = ELoadTestBotState::LBS_Seek;
+			StateTime = 10.f;
+		}
+
+		return;
+	}
+
+	UItem* Item = Items[FMath::RandRange(0, Items.Num() - 1)];
+
+	if (!Item)
+		return;
+
+	if (Roll < TakeChance + DropChance)
+	{
+		UEquippableItem* EquippableItem = Cast<UEquippableItem>(Item);
+
+		if (!EquippableItem || !EquippableItem->IsEquipped())
+			Character->DropItem(Item, Item->GetQuantity());
+	}
+	else
+	{
+		// Food gets eaten, gear and weapons get equipped or unequipped.
+		Character->UseItem(Item);
+	}
+}
+
+APickup* ULoadTestBot::FindPickup(const ASurvivalCharacter* Character) const
+{
+	const FVector Location = Character->GetActorLocation();
+	APickup* ClosestPickup = nullptr;
+	float ClosestDistSquared = FMath::Square(SearchRadius);
+
+	auto ConsiderPickup = [&](APickup* Pickup)
+	{
+		const float DistSquared = FVector::DistSquared(Location, Pickup->GetActorLocation());
+
+		if (Pickup->GetItem() && !Pickup->IsHidden() && DistSquared < ClosestDistSquared)
+		{
+			ClosestPickup = Pickup;
+			ClosestDistSquared = DistSquared;
+		}
+	};
+
+	// The registry only exists on the server, headless clients walk the pickups they have relevant instead.
+	if (Character->HasAuthority())
+	{
+		if (const UPickupSubsystem* PickupSubsystem = Character->GetWorld()->GetSubsystem<UPickupSubsystem>())
+			PickupSubsystem->ForEachPickupNear(Location, SearchRadius, ConsiderPickup);
+	}
+	else
+	{
+		for (TActorIterator<APickup> It(Character->GetWorld()); It; ++It)
+		{
+			ConsiderPickup(*It);
+		}
+	}
+
+	return ClosestPickup;
+}
+
+void ULoadTestBot::LookAt(AController* Controller, const FVector& Location) const
+{
+	FVector EyeLocation;
+	FRotator EyeRotation;
+	Controller->GetPlayerViewPoint(EyeLocation, EyeRotation);
+
+	Controller->SetControlRotation((Location - EyeLocation).Rotation());
+}
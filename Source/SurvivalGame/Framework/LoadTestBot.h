@@ -0,0 +1,59 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/NoExportTypes.h"
+#include "LoadTestBot.generated.h"
+
+UENUM()
+enum class ELoadTestBotState : uint8
+{
+	LBS_Idle,
+	LBS_Seek,
+	LBS_Aim,
+	LBS_Interact
+};
+
+/**
+ * Load test brain that plays a survival character like a very impatient player: walks to pickups and takes them,
+ * drops, uses and equips items. Everything goes through the character's normal functions, so when it drives a
+ * remote client the server sees the same RPCs a real player would send.
+ */
+UCLASS()
+class SURVIVALGAME_API ULoadTestBot : public UObject
+{
+	GENERATED_BODY()
+
+public:
+	ULoadTestBot();
+
+	void TickBot(class AController* Controller, const float DeltaTime);
+
+	// Seconds between actions, picked at random within this range.
+	UPROPERTY()
+	FVector2D ActionInterval;
+
+	// How far the bot looks for a pickup to go after.
+	UPROPERTY()
+	float SearchRadius;
+
+	UPROPERTY()
+	float TakeChance;
+
+	UPROPERTY()
+	float DropChance;
+
+private:
+
+	void ChooseAction(class ASurvivalCharacter* Character);
+
+	class APickup* FindPickup(const class ASurvivalCharacter* Character) const;
+
+	void LookAt(class AController* Controller, const FVector& Location) const;
+
+	ELoadTestBotState State;
+	float StateTime;
+
+	TWeakObjectPtr<class APickup> TargetPickup;
+};
@@ -0,0 +1,20 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Framework/LoadTestBotController.h"
+
+#include "Framework/LoadTestBot.h"
+
+ALoadTestBotController::ALoadTestBotController()
+{
+	PrimaryActorTick.bCanEverTick = true;
+
+	Bot = CreateDefaultSubobject<ULoadTestBot>(TEXT("Bot"));
+}
+
+void ALoadTestBotController::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	Bot->TickBot(this, DeltaTime);
+}
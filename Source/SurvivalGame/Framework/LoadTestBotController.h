@@ -0,0 +1,29 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Controller.h"
+#include "LoadTestBotController.generated.h"
+
+/**
+ * In process load test bot. Runs a ULoadTestBot on the server with no connection behind it, so it costs game
+ * thread and replication time like a player but skips the RPC round trips.
+ */
+UCLASS()
+class SURVIVALGAME_API ALoadTestBotController : public AController
+{
+	GENERATED_BODY()
+
+public:
+	ALoadTestBotController();
+
+	virtual void Tick(float DeltaTime) override;
+
+	FORCEINLINE class ULoadTestBot* GetBot() const { return Bot; }
+
+protected:
+
+	UPROPERTY()
+	class ULoadTestBot* Bot;
+};
@@ -0,0 +1,253 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Framework/LoadTestGameMode.h"
+#include "Kismet/GameplayStatics.h"
+#include "Engine/World.h"
+#include "Engine/NetDriver.h"
+#include "GameFramework/PlayerStart.h"
+#include "HAL/FileManager.h"
+#include "Misc/Paths.h"
+#include "Misc/App.h"
+#include "CoreGlobals.h"
+#include "EngineUtils.h"
+
+#include "Framework/LoadTestBotController.h"
+#include "Player/SurvivalCharacter.h"
+#include "World/Pickup.h"
+#include "World/PickupSubsystem.h"
+#include "Items/Item.h"
+
+ALoadTestGameMode::ALoadTestGameMode()
+	:SeedRadius(20000.f),
+	SeedSpawnsPerFrame(100),
+	SampleInterval(1.f),
+	NumBots(0),
+	MaxBots(0),
+	BotStep(0),
+	RampInterval(30.f),
+	NumSeedPickups(0),
+	Duration(0.f),
+	LoadedPickupClass(nullptr),
+	LoadedBotPawnClass(nullptr),
+	SeedCenter(FVector::ZeroVector),
+	TimeSinceRamp(0.f),
+	TimeSinceSample(0.f),
+	ElapsedTime(0.f),
+	SampleFrames(0),
+	SampleFrameMs(0.0),
+	SampleMaxFrameMs(0.0),
+	SampleGameThreadMs(0.0),
+	SampleNetFlushMs(0.0),
+	PostActorTickTime(0.0)
+{
+	PrimaryActorTick.bCanEverTick = true;
+}
+
+void ALoadTestGameMode::InitGame(const FString& MapName, const FString& Options, FString& ErrorMessage)
+{
+	Super::InitGame(MapName, Options, ErrorMessage);
+
+	NumBots = UGameplayStatics::GetIntOption(Options, TEXT("Bots"), 10);
+	MaxBots = FMath::Max(UGameplayStatics::GetIntOption(Options, TEXT("MaxBots"), NumBots), NumBots);
+	BotStep = UGameplayStatics::GetIntOption(Options, TEXT("BotStep"), 0);
+	RampInterval = UGameplayStatics::GetIntOption(Options, TEXT("RampInterval"), 30);
+	NumSeedPickups = UGameplayStatics::GetIntOption(Options, TEXT("Pickups"), 1000);
+	Duration = UGameplayStatics::GetIntOption(Options, TEXT("Duration"), 0);
+
+	LoadedBotPawnClass = BotPawnClass.LoadSynchronous();
+	LoadedPickupClass = SeedPickupClass.LoadSynchronous();
+
+	for (const TSoftClassPtr<UItem>& ItemClass : SeedItemClasses)
+	{
+		if (UClass* LoadedItemClass = ItemClass.LoadSynchronous())
+			LoadedItemClasses.Add(LoadedItemClass);
+	}
+}
+
+void ALoadTestGameMode::StartPlay()
+{
+	Super::StartPlay();
+
+	for (TActorIterator<APlayerStart> It(GetWorld()); It; ++It)
+	{
+		SeedCenter = It->GetActorLocation();
+		break;
+	}
+
+	for (int32 Index = 0; Index < NumBots; ++Index)
+	{
+		SpawnBot();
+	}
+
+	PostActorTickHandle = FWorldDelegates::OnWorldPostActorTick.AddUObject(this, &ALoadTestGameMode::OnPostActorTick);
+	TickEndHandle = FWorldDelegates::OnWorldTickEnd.AddUObject(this, &ALoadTestGameMode::OnTickEnd);
+
+	OpenCsv();
+
+	UE_LOG(LogTemp, Display, TEXT("Load test started with %i bots (max %i, +%i every %.0fs) and %i pickups"), NumBots, MaxBots, BotStep, RampInterval, NumSeedPickups);
+}
+
+void ALoadTestGameMode::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	FWorldDelegates::OnWorldPostActorTick.Remove(PostActorTickHandle);
+	FWorldDelegates::OnWorldTickEnd.Remove(TickEndHandle);
+
+	CsvWriter.Reset();
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void ALoadTestGameMode::Tick(float DeltaSeconds)
+{
+	Super::Tick(DeltaSeconds);
+
+	ElapsedTime += DeltaSeconds;
+	TimeSinceRamp += DeltaSeconds;
+	TimeSinceSample += DeltaSeconds;
+
+	TopUpPickups();
+
+	if (BotStep > 0 && TimeSinceRamp >= RampInterval && Bots.Num() < MaxBots)
+	{
+		TimeSinceRamp = 0.f;
+
+		for (int32 Index = 0; Index < BotStep && Bots.Num() < MaxBots; ++Index)
+		{
+			SpawnBot();
+		}
+	}
+
+	if (TimeSinceSample >= SampleInterval)
+	{
+		WriteSample();
+		TimeSinceSample = 0.f;
+	}
+
+	if (Duration > 0.f && ElapsedTime >= Duration)
+	{
+		UE_LOG(LogTemp, Display, TEXT("Load test finished after %.0fs"), ElapsedTime);
+		FPlatformMisc::RequestExit(false);
+	}
+}
+
+void ALoadTestGameMode::SpawnBot()
+{
+	UClass* PawnClass = LoadedBotPawnClass ? LoadedBotPawnClass : DefaultPawnClass.Get();
+
+	if (!PawnClass)
+		return;
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+
+	APawn* Pawn = GetWorld()->SpawnActor<APawn>(PawnClass, GetRandomSeedLocation(), FRotator::ZeroRotator, SpawnParams);
+	ALoadTestBotController* Bot = GetWorld()->SpawnActor<ALoadTestBotController>(SpawnParams);
+
+	if (!Pawn || !Bot)
+		return;
+
+	Bot->Possess(Pawn);
+	Bots.Add(Bot);
+}
+
+void ALoadTestGameMode::TopUpPickups()
+{
+	const UPickupSubsystem* PickupSubsystem = GetWorld()->GetSubsystem<UPickupSubsystem>();
+
+	if (!PickupSubsystem || !LoadedPickupClass || LoadedItemClasses.Num() == 0)
+		return;
+
+	const int32 NumToSpawn = FMath::Min(NumSeedPickups - PickupSubsystem->GetPickups().Num(), SeedSpawnsPerFrame);
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+	for (int32 Index = 0; Index < NumToSpawn; ++Index)
+	{
+		UClass* ItemClass = LoadedItemClasses[FMath::RandRange(0, LoadedItemClasses.Num() - 1)];
+
+		if (APickup* Pickup = GetWorld()->SpawnActor<APickup>(LoadedPickupClass, GetRandomSeedLocation(), FRotator::ZeroRotator, SpawnParams))
+			Pickup->InitPickup(ItemClass, 1);
+	}
+}
+
+FVector ALoadTestGameMode::GetRandomSeedLocation() const
+{
+	const FVector2D Offset = FMath::RandPointInCircle(SeedRadius);
+	return SeedCenter + FVector(Offset.X, Offset.Y, 0.f);
+}
+
+void ALoadTestGameMode::OpenCsv()
+{
+	const FString Filename = FPaths::ProfilingDir() / TEXT("LoadTest") / FString::Printf(TEXT("LoadTest-%s.csv"), *FDateTime::Now().ToString());
+
+	CsvWriter.Reset(IFileManager::Get().CreateFileWriter(*Filename));
+
+	if (!CsvWriter)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Couldn't open %s for the load test results"), *Filename);
+		return;
+	}
+
+	const FTCHARToUTF8 Header(TEXT("Time,Bots,Clients,Pickups,AvgFrameMs,MaxFrameMs,GameThreadMs,NetFlushMs,InKBps,OutKBps\n"));
+	CsvWriter->Serialize((void*)Header.Get(), Header.Length());
+
+	UE_LOG(LogTemp, Display, TEXT("Writing load test results to %s"), *Filename);
+}
+
+void ALoadTestGameMode::WriteSample()
+{
+	const UNetDriver* NetDriver = GetWorld()->GetNetDriver();
+	const UPickupSubsystem* PickupSubsystem = GetWorld()->GetSubsystem<UPickupSubsystem>();
+	const int32 Frames = FMath::Max(SampleFrames, 1);
+
+	const FString Row = FString::Printf(TEXT("%.1f,%i,%i,%i,%.2f,%.2f,%.2f,%.2f,%.1f,%.1f\n"),
+		ElapsedTime,
+		Bots.Num(),
+		NetDriver ? NetDriver->ClientConnections.Num() : 0,
+		PickupSubsystem ? PickupSubsystem->GetPickups().Num() : 0,
+		SampleFrameMs / Frames,
+		SampleMaxFrameMs,
+		SampleGameThreadMs / Frames,
+		SampleNetFlushMs / Frames,
+		NetDriver ? NetDriver->InBytesPerSecond / 1024.f : 0.f,
+		NetDriver ? NetDriver->OutBytesPerSecond / 1024.f : 0.f);
+
+	if (CsvWriter)
+	{
+		const FTCHARToUTF8 RowUtf8(*Row);
+		CsvWriter->Serialize((void*)RowUtf8.Get(), RowUtf8.Length());
+		CsvWriter->Flush();
+	}
+
+	SampleFrames = 0;
+	SampleFrameMs = 0.0;
+	SampleMaxFrameMs = 0.0;
+	SampleGameThreadMs = 0.0;
+	SampleNetFlushMs = 0.0;
+}
+
+void ALoadTestGameMode::OnPostActorTick(UWorld* World, ELevelTick TickType, float DeltaSeconds)
+{
+	if (World == GetWorld())
+		PostActorTickTime = FPlatformTime::Seconds();
+}
+
+void ALoadTestGameMode::OnTickEnd(UWorld* World, ELevelTick TickType, float DeltaSeconds)
+{
+	if (World != GetWorld())
+		return;
+
+	// Everything between the end of actor ticking and the end of the world tick is mostly the net driver
+	// flushing, i.e. replicating actors.
+	if (PostActorTickTime > 0.0)
+		SampleNetFlushMs += (FPlatformTime::Seconds() - PostActorTickTime) * 1000.0;
+
+	const double FrameMs = FApp::GetDeltaTime() * 1000.0;
+
+	++SampleFrames;
+	SampleFrameMs += FrameMs;
+	SampleMaxFrameMs = FMath::Max(SampleMaxFrameMs, FrameMs);
+	SampleGameThreadMs += FPlatformTime::ToMilliseconds(GGameThreadTime);
+}
@@ -0,0 +1,104 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Framework/SurvivalGameGameModeBase.h"
+#include "LoadTestGameMode.generated.h"
+
+/**
+ * Capacity test mode for a headless dedicated server. Seeds pickups, ramps up in process bots and writes a CSV of
+ * frame time, net flush time and bandwidth to Saved/Profiling/LoadTest once a second.
+ *
+ *   SurvivalGameServer <Map>?game=/Script/SurvivalGame.LoadTestGameMode?Bots=20?MaxBots=200?BotStep=10?Pickups=5000 -nullrhi -log
+ *
+ * Options: Bots (starting count), MaxBots, BotStep (bots added every RampInterval seconds), RampInterval, Pickups,
+ * Duration (seconds before the server exits, 0 runs forever). Real clients can join as bots too, started with
+ * "SurvivalGame 127.0.0.1 -nullrhi -LoadTestBot", which exercises the full RPC paths.
+ */
+UCLASS(Config = Game)
+class SURVIVALGAME_API ALoadTestGameMode : public ASurvivalGameGameModeBase
+{
+	GENERATED_BODY()
+
+public:
+	ALoadTestGameMode();
+
+	virtual void InitGame(const FString& MapName, const FString& Options, FString& ErrorMessage) override;
+	virtual void StartPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+	virtual void Tick(float DeltaSeconds) override;
+
+protected:
+
+	UPROPERTY(Config)
+	TSoftClassPtr<class ASurvivalCharacter> BotPawnClass;
+
+	UPROPERTY(Config)
+	TSoftClassPtr<class APickup> SeedPickupClass;
+
+	UPROPERTY(Config)
+	TArray<TSoftClassPtr<class UItem>> SeedItemClasses;
+
+	// Pickups and bots are scattered within this distance of the first player start.
+	UPROPERTY(Config)
+	float SeedRadius;
+
+	// Pickups spawned per frame while topping the world back up to the seed count.
+	UPROPERTY(Config)
+	int32 SeedSpawnsPerFrame;
+
+	UPROPERTY(Config)
+	float SampleInterval;
+
+private:
+
+	void SpawnBot();
+	void TopUpPickups();
+	FVector GetRandomSeedLocation() const;
+
+	void OpenCsv();
+	void WriteSample();
+
+	void OnPostActorTick(UWorld* World, ELevelTick TickType, float DeltaSeconds);
+	void OnTickEnd(UWorld* World, ELevelTick TickType, float DeltaSeconds);
+
+	int32 NumBots;
+	int32 MaxBots;
+	int32 BotStep;
+	float RampInterval;
+	int32 NumSeedPickups;
+	float Duration;
+
+	UPROPERTY()
+	TArray<class ALoadTestBotController*> Bots;
+
+	UPROPERTY()
+	TArray<UClass*> LoadedItemClasses;
+
+	UPROPERTY()
+	UClass* LoadedPickupClass;
+
+	UPROPERTY()
+	UClass* LoadedBotPawnClass;
+
+	FVector SeedCenter;
+
+	float TimeSinceRamp;
+	float TimeSinceSample;
+	float ElapsedTime;
+
+	// Accumulated over the current sample.
+	int32 SampleFrames;
+	double SampleFrameMs;
+	double SampleMaxFrameMs;
+	double SampleGameThreadMs;
+	double SampleNetFlushMs;
+
+	double PostActorTickTime;
+
+	FDelegateHandle PostActorTickHandle;
+	FDelegateHandle TickEndHandle;
+
+	TUniquePtr<FArchive> CsvWriter;
+};
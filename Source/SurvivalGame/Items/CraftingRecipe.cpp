@@ -0,0 +1,13 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Items/CraftingRecipe.h"
+
+#define LOCTEXT_NAMESPACE "Crafting"
+
+UCraftingRecipe::UCraftingRecipe()
+	:RecipeDisplayName(LOCTEXT("RecipeName", "Recipe"))
+{
+}
+
+#undef LOCTEXT_NAMESPACE
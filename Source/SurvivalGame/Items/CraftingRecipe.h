@@ -0,0 +1,29 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "Components/InventoryComponent.h"
+#include "CraftingRecipe.generated.h"
+
+/**
+ * Turns Ingredients into Products. Ingredients match their exact class, the same way HasItem does.
+ */
+UCLASS(BlueprintType)
+class SURVIVALGAME_API UCraftingRecipe : public UDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	UCraftingRecipe();
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Crafting")
+	FText RecipeDisplayName;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Crafting")
+	TArray<FItemQuantity> Ingredients;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Crafting")
+	TArray<FItemQuantity> Products;
+};
@@ -6,6 +6,7 @@
 
 #include "Player/SurvivalCharacter.h"
 #include "Components/InventoryComponent.h"
+#include "Components/InventoryJournal.h"
 
 #define LOCTEXT_NAMESPACE "EquippableItem"
 
@@ -23,10 +24,17 @@ void UEquippableItem::GetLifetimeReplicatedProps(TArray< class FLifetimeProperty
 	DOREPLIFETIME(UEquippableItem, bIsEquipped);
 }
 
-void UEquippableItem::Use(ASurvivalCharacter* Character)
+void UEquippableItem::ResetForReuse()
+{
+	Super::ResetForReuse();
+
+	bIsEquipped = false;
+}
+
+bool UEquippableItem::Use(ASurvivalCharacter* Character)
 {
 	if ( !Character || !Character->HasAuthority())
-		return;
+		return false;
 
 	if (Character->GetEquippedItems().Contains(Slot) && !bIsEquipped)
 	{
@@ -36,6 +44,35 @@ void UEquippableItem::Use(ASurvivalCharacter* Character)
 
 	SetEquipped(!IsEquipped());
 
+	// Equipping can be refused by the character, in which case the slot doesn't hold us.
+	return (Character->GetEquippedItems().FindRef(Slot) == this) == IsEquipped();
+}
+
+bool UEquippableItem::PredictUse(ASurvivalCharacter* Character, FPredictedItemUse& Prediction)
+{
+	if (!Character)
+		return false;
+
+	// Same as Use, equipping swaps out whatever is already in the slot.
+	if (!bIsEquipped)
+	{
+		if (UEquippableItem* AlreadyEquippedItem = Character->GetEquippedItems().FindRef(Slot))
+		{
+			Prediction.DisplacedItem = AlreadyEquippedItem;
+			AlreadyEquippedItem->SetEquipped(false);
+		}
+	}
+
+	SetEquipped(!IsEquipped());
+	return true;
+}
+
+void UEquippableItem::RevertPredictedUse(ASurvivalCharacter* Character, const FPredictedItemUse& Prediction)
+{
+	SetEquipped(!IsEquipped());
+
+	if (UEquippableItem* DisplacedItem = Cast<UEquippableItem>(Prediction.DisplacedItem))
+		DisplacedItem->SetEquipped(true);
 }
 
 bool UEquippableItem::Equip(ASurvivalCharacter* Character)
@@ -61,6 +98,10 @@ bool UEquippableItem::ShouldShowInInventory() const
 
 void UEquippableItem::SetEquipped(bool bNewEquipped)
 {
+	// OwningInventory is only set on the server, predicted equips on the client aren't journaled.
+	if (OwningInventory)
+		FInventoryJournal::Record(OwningInventory, EInventoryJournalOp::Equip, this, bNewEquipped ? 1 : 0);
+
 	bIsEquipped = bNewEquipped;
 	EquipStatusChanged();
 	MarkDirtyForReplication();
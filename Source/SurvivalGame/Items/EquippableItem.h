@@ -19,7 +19,8 @@ enum class EEquippableSlot : uint8
 	EIS_Hands UMETA(DisplayName = "Hands"),
 	EIS_Backpack UMETA(DisplayName = "Backpack"),
 	EIS_PrimaryWeapon UMETA(DisplayName = "Primary Weapon"),
-	EIS_Throwable UMETA(DisplayName = "Throwable Item")
+	EIS_Throwable UMETA(DisplayName = "Throwable Item"),
+	EIS_MAX UMETA(Hidden)
 };
 
 UCLASS(Abstract, NotBlueprintable)
@@ -36,7 +37,9 @@ public:
 
 	virtual void GetLifetimeReplicatedProps(TArray< class FLifetimeProperty >& OutLifetimeProps) const override;
 	
-	virtual void Use(class ASurvivalCharacter* Character) override;
+	virtual bool Use(class ASurvivalCharacter* Character) override;
+	virtual bool PredictUse(class ASurvivalCharacter* Character, FPredictedItemUse& Prediction) override;
+	virtual void RevertPredictedUse(class ASurvivalCharacter* Character, const FPredictedItemUse& Prediction) override;
 
 	UFUNCTION(BlueprintCallable, Category = "Equippables")
 	virtual bool Equip(class ASurvivalCharacter* Character);
@@ -46,6 +49,8 @@ public:
 
 	virtual bool ShouldShowInInventory() const override;
 
+	virtual void ResetForReuse() override;
+
 	UFUNCTION(BlueprintPure, Category = "Equippables")
 	bool IsEquipped() { return bIsEquipped; }
 
@@ -3,19 +3,49 @@
 
 #include "Items/FoodItem.h"
 
+#include "Player/SurvivalCharacter.h"
+#include "Components/InventoryComponent.h"
+#include "World/SurvivalStatsSubsystem.h"
+
 #define LOCTEXT_NAMESPACE "FoodItem"
 
 UFoodItem::UFoodItem()
-	:HealAmount(20.f)
+	:HealAmount(20.f),
+	HungerAmount(30.f),
+	ThirstAmount(0.f)
 {
 	UseActionText = LOCTEXT("ItemUseAction", "Consume");
 }
 
-void UFoodItem::Use(ASurvivalCharacter* Character)
+bool UFoodItem::Use(ASurvivalCharacter* Character)
 {
-	//TODO: Heal Character
+	if (!Character || !Character->HasAuthority() || !OwningInventory || Quantity <= 0)
+		return false;
+
+	if (USurvivalStatsSubsystem* SurvivalStatsSubsystem = Character->GetWorld()->GetSubsystem<USurvivalStatsSubsystem>())
+	{
+		SurvivalStatsSubsystem->ApplyEffect(Character, ESurvivalStat::SS_Health, HealAmount);
+		SurvivalStatsSubsystem->ApplyEffect(Character, ESurvivalStat::SS_Hunger, HungerAmount);
+		SurvivalStatsSubsystem->ApplyEffect(Character, ESurvivalStat::SS_Thirst, ThirstAmount);
+	}
 
-	UE_LOG(LogTemp, Warning, TEXT("Nom Nom"));
+	return OwningInventory->ConsumeItem(this, 1) > 0;
+}
+
+bool UFoodItem::PredictUse(ASurvivalCharacter* Character, FPredictedItemUse& Prediction)
+{
+	if (Quantity <= 0)
+		return false;
+
+	SetQuantity(Quantity - 1);
+	OnRep_Quantity();
+	return true;
+}
+
+void UFoodItem::RevertPredictedUse(ASurvivalCharacter* Character, const FPredictedItemUse& Prediction)
+{
+	SetQuantity(Quantity + 1);
+	OnRep_Quantity();
 }
 
 #undef LOCTEXT_NAMESPACE
@@ -21,6 +21,14 @@ public:
 	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Healing")
 	float HealAmount;
 
-	virtual void Use(class ASurvivalCharacter* Character) override;
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Healing")
+	float HungerAmount;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Healing")
+	float ThirstAmount;
+
+	virtual bool Use(class ASurvivalCharacter* Character) override;
+	virtual bool PredictUse(class ASurvivalCharacter* Character, FPredictedItemUse& Prediction) override;
+	virtual void RevertPredictedUse(class ASurvivalCharacter* Character, const FPredictedItemUse& Prediction) override;
 	
 };
@@ -0,0 +1,149 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Items/GearAppearanceSubsystem.h"
+#include "AssetRegistry/AssetRegistryModule.h"
+#include "Engine/AssetManager.h"
+#include "Engine/Blueprint.h"
+#include "Engine/Engine.h"
+#include "UObject/UObjectIterator.h"
+
+#include "Items/GearItem.h"
+
+UGearAppearanceSubsystem* UGearAppearanceSubsystem::Get()
+{
+	return GEngine ? GEngine->GetEngineSubsystem<UGearAppearanceSubsystem>() : nullptr;
+}
+
+void UGearAppearanceSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	IAssetRegistry& AssetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>("AssetRegistry").Get();
+
+	// Cooked games have the whole registry from the start, the editor scans in the background and gear blueprints it
+	// hasn't found yet would shift every id after them, so the table waits for the scan rather than blocking on it.
+	if (AssetRegistry.IsLoadingAssets())
+		FilesLoadedHandle = AssetRegistry.OnFilesLoaded().AddUObject(this, &UGearAppearanceSubsystem::BuildGearIds);
+	else
+		BuildGearIds();
+}
+
+void UGearAppearanceSubsystem::Deinitialize()
+{
+	if (FilesLoadedHandle.IsValid())
+	{
+		if (FAssetRegistryModule* AssetRegistryModule = FModuleManager::GetModulePtr<FAssetRegistryModule>("AssetRegistry"))
+			AssetRegistryModule->Get().OnFilesLoaded().Remove(FilesLoadedHandle);
+
+		FilesLoadedHandle.Reset();
+	}
+
+	GearClassPaths.Empty();
+	GearIds.Empty();
+	LoadedGearClasses.Empty();
+
+	Super::Deinitialize();
+}
+
+uint8 UGearAppearanceSubsystem::GetGearId(const UClass* GearClass) const
+{
+	return GearClass ? GearIds.FindRef(FName(*GearClass->GetPathName())) : 0;
+}
+
+TSubclassOf<UGearItem> UGearAppearanceSubsystem::FindGearClass(const uint8 GearId) const
+{
+	return LoadedGearClasses.IsValidIndex(GearId - 1) ? LoadedGearClasses[GearId - 1] : nullptr;
+}
+
+void UGearAppearanceSubsystem::LoadGearClass(const uint8 GearId, FStreamableDelegate OnLoaded)
+{
+	if (!GearClassPaths.IsValidIndex(GearId - 1))
+		return;
+
+	if (LoadedGearClasses[GearId - 1])
+	{
+		OnLoaded.ExecuteIfBound();
+		return;
+	}
+
+	const FSoftClassPath ClassPath = GearClassPaths[GearId - 1];
+	TWeakObjectPtr<UGearAppearanceSubsystem> WeakThis(this);
+
+	UAssetManager::GetStreamableManager().RequestAsyncLoad(ClassPath, FStreamableDelegate::CreateLambda([WeakThis, GearId, ClassPath, OnLoaded]()
+	{
+		if (!WeakThis.IsValid() || !WeakThis->LoadedGearClasses.IsValidIndex(GearId - 1))
+			return;
+
+		UClass* GearClass = ClassPath.ResolveClass();
+
+		if (!GearClass || !GearClass->IsChildOf(UGearItem::StaticClass()))
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Couldn't load gear class %s for gear id %d"), *ClassPath.ToString(), GearId);
+			return;
+		}
+
+		WeakThis->LoadedGearClasses[GearId - 1] = GearClass;
+		OnLoaded.ExecuteIfBound();
+	}));
+}
+
+void UGearAppearanceSubsystem::BuildGearIds()
+{
+	if (FilesLoadedHandle.IsValid())
+	{
+		FModuleManager::GetModuleChecked<FAssetRegistryModule>("AssetRegistry").Get().OnFilesLoaded().Remove(FilesLoadedHandle);
+		FilesLoadedHandle.Reset();
+	}
+
+	TArray<FString> ClassPaths;
+
+	for (TObjectIterator<UClass> It; It; ++It)
+	{
+		if (It->HasAnyClassFlags(CLASS_Native) && !It->HasAnyClassFlags(CLASS_Abstract | CLASS_Deprecated) && It->IsChildOf(UGearItem::StaticClass()))
+			ClassPaths.Add(It->GetPathName());
+	}
+
+	IAssetRegistry& AssetRegistry = FModuleManager::GetModuleChecked<FAssetRegistryModule>("AssetRegistry").Get();
+
+	TArray<FAssetData> Blueprints;
+	AssetRegistry.GetAssetsByClass(UBlueprint::StaticClass()->GetFName(), Blueprints, true);
+
+	// Goes by the registry tags so finding the gear doesn't load every blueprint in the game.
+	for (const FAssetData& Blueprint : Blueprints)
+	{
+		FString NativeParentPath;
+		FString GeneratedClassPath;
+
+		if (!Blueprint.GetTagValue(FBlueprintTags::NativeParentClassPath, NativeParentPath) || !Blueprint.GetTagValue(FBlueprintTags::GeneratedClassPath, GeneratedClassPath))
+			continue;
+
+		const UClass* NativeParent = FindObject<UClass>(nullptr, *FPackageName::ExportTextPathToObjectPath(NativeParentPath));
+
+		if (NativeParent && NativeParent->IsChildOf(UGearItem::StaticClass()))
+			ClassPaths.Add(FPackageName::ExportTextPathToObjectPath(GeneratedClassPath));
+	}
+
+	ClassPaths.Sort();
+
+	// Id 0 is nothing, so there is room for one class less than a uint8 holds.
+	if (ClassPaths.Num() >= MAX_uint8)
+	{
+		UE_LOG(LogTemp, Error, TEXT("%d gear classes but only %d gear ids, the rest won't show up on other players"), ClassPaths.Num(), MAX_uint8 - 1);
+		ClassPaths.SetNum(MAX_uint8 - 1);
+	}
+
+	for (const FString& ClassPath : ClassPaths)
+	{
+		GearClassPaths.Add(FSoftClassPath(ClassPath));
+		GearIds.Add(FName(*ClassPath), (uint8)GearClassPaths.Num());
+	}
+
+	// Native classes and blueprints that happen to be loaded already don't need to wait on anything.
+	LoadedGearClasses.SetNumZeroed(GearClassPaths.Num());
+
+	for (int32 Index = 0; Index < GearClassPaths.Num(); ++Index)
+	{
+		LoadedGearClasses[Index] = GearClassPaths[Index].ResolveClass();
+	}
+}
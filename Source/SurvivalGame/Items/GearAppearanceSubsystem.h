@@ -0,0 +1,49 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/EngineSubsystem.h"
+#include "Engine/StreamableManager.h"
+#include "GearAppearanceSubsystem.generated.h"
+
+/**
+ * Gives every gear class, native or blueprint, a small id other players can be told about instead of the class.
+ * Ids come from the gear classes sorted by path, so the server and its clients agree on them as long as they run the
+ * same content, without anyone keeping a list. The table is built from the asset registry at startup, once the
+ * registry has finished scanning, and gear classes are only loaded, asynchronously, when someone needs to draw them.
+ */
+UCLASS()
+class SURVIVALGAME_API UGearAppearanceSubsystem : public UEngineSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	static UGearAppearanceSubsystem* Get();
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	// 0 if the class isn't gear or didn't get an id.
+	uint8 GetGearId(const UClass* GearClass) const;
+
+	// nullptr for 0, an unknown id, or a class that hasn't loaded yet.
+	TSubclassOf<class UGearItem> FindGearClass(const uint8 GearId) const;
+
+	// Starts loading the class for GearId, OnLoaded is called once it has. Never called for 0 or an unknown id.
+	void LoadGearClass(const uint8 GearId, FStreamableDelegate OnLoaded);
+
+private:
+
+	void BuildGearIds();
+
+	// Index + 1 is the gear id.
+	TArray<FSoftClassPath> GearClassPaths;
+	TMap<FName, uint8> GearIds;
+
+	// Parallel to GearClassPaths, filled in as classes load.
+	UPROPERTY()
+	TArray<UClass*> LoadedGearClasses;
+
+	FDelegateHandle FilesLoadedHandle;
+};
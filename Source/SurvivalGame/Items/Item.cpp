@@ -5,6 +5,7 @@
 #include "Net/UnrealNetwork.h"
 
 #include "Components/InventoryComponent.h"
+#include "Items/ItemPoolSubsystem.h"
 
 #define LOCTEXT_NAMESPACE "Item"
 
@@ -15,17 +16,31 @@ UItem::UItem()
 	bIsStackable(true),
 	MaxStackSize(2),
 	Quantity(1),
-	RepKey(0)
+	RepKey(0),
+	GridSize(1, 1),
+	GridPosition(INDEX_NONE, INDEX_NONE),
+	bGridRotated(false)
 {
 
 }
 
 bool UItem::ShouldShowInInventory() const
 {
-	return true;
+	// Only a predicted consume leaves an item at zero while it waits on the server.
+	return Quantity > 0;
+}
+
+bool UItem::Use(ASurvivalCharacter* Character)
+{
+	return false;
 }
 
-void UItem::Use(ASurvivalCharacter* Character)
+bool UItem::PredictUse(ASurvivalCharacter* Character, FPredictedItemUse& Prediction)
+{
+	return false;
+}
+
+void UItem::RevertPredictedUse(ASurvivalCharacter* Character, const FPredictedItemUse& Prediction)
 {
 }
 
@@ -37,9 +52,24 @@ void UItem::SetQuantity(const int32 NewQuantity)
 {
 	if (NewQuantity == Quantity)
 		return;
+
+	const int32 OldQuantity = Quantity;
 		
 	Quantity = FMath::Clamp(NewQuantity, 0, bIsStackable ? MaxStackSize : 1);
 	MarkDirtyForReplication();
+
+	if (OwningInventory && Quantity != OldQuantity)
+		OwningInventory->NotifyQuantityChanged(GetClass(), Quantity - OldQuantity);
+}
+
+void UItem::ResetForReuse()
+{
+	Quantity = GetClass()->GetDefaultObject<UItem>()->Quantity;
+	OwningInventory = nullptr;
+	RepKey = 0;
+	GridPosition = FIntPoint(INDEX_NONE, INDEX_NONE);
+	bGridRotated = false;
+	OnItemModified.Clear();
 }
 
 void UItem::MarkDirtyForReplication()
@@ -60,6 +90,8 @@ void UItem::GetLifetimeReplicatedProps(TArray<class FLifetimeProperty>& OutLifet
 	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
 
 	DOREPLIFETIME(UItem, Quantity);
+	DOREPLIFETIME(UItem, GridPosition);
+	DOREPLIFETIME(UItem, bGridRotated);
 }
 
 bool UItem::IsSupportedForNetworking() const
@@ -67,6 +99,14 @@ bool UItem::IsSupportedForNetworking() const
 	return true;
 }
 
+void UItem::BeginDestroy()
+{
+	if (!HasAnyFlags(RF_ClassDefaultObject | RF_ArchetypeObject))
+		UItemPoolSubsystem::NotifyItemDestroyed();
+
+	Super::BeginDestroy();
+}
+
 #if WITH_EDITOR
 void UItem::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
 {
@@ -4,6 +4,7 @@
 
 #include "CoreMinimal.h"
 #include "UObject/NoExportTypes.h"
+#include "GameplayTagContainer.h"
 #include "Item.generated.h"
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnItemModified);
@@ -18,6 +19,30 @@ enum class EItemRarity : uint8
 	IR_Legendary UMETA(DisplayName = "Legendary")
 };
 
+// Client side record of a use that was applied before the server confirmed it.
+USTRUCT()
+struct FPredictedItemUse
+{
+	GENERATED_BODY()
+
+public:
+	FPredictedItemUse()
+		:PredictionKey(0),
+		Item(nullptr),
+		DisplacedItem(nullptr)
+	{}
+
+	UPROPERTY()
+	int32 PredictionKey;
+
+	UPROPERTY()
+	class UItem* Item;
+
+	// Another item the use changed, e.g. whatever was in the slot we equipped into.
+	UPROPERTY()
+	class UItem* DisplacedItem;
+};
+
 UCLASS(Blueprintable, EditInlineNew, DefaultToInstanced)
 class SURVIVALGAME_API UItem : public UObject
 {
@@ -28,6 +53,7 @@ protected:
 
 	virtual void GetLifetimeReplicatedProps(TArray< class FLifetimeProperty >& OutLifetimeProps) const override;
 	virtual bool IsSupportedForNetworking() const override;
+	virtual void BeginDestroy() override;
 
 #if WITH_EDITOR
 	virtual void PostEditChangeProperty(struct FPropertyChangedEvent& PropertyChangedEvent) override;
@@ -55,6 +81,10 @@ public:
 	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Item")
 	EItemRarity Rarity;
 
+	// What the item is, e.g. Item.Food or Item.Ammo.9mm, for inventory queries. Read from the class default only.
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Item")
+	FGameplayTagContainer ItemTags;
+
 	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Item")
 	float Weight;
 
@@ -85,11 +115,22 @@ public:
 	UPROPERTY(BlueprintAssignable)
 	FOnItemModified OnItemModified;
 
-	virtual void Use(class ASurvivalCharacter* Character);
+	// Returns false if using the item failed or changed nothing.
+	virtual bool Use(class ASurvivalCharacter* Character);
+
+	// Client side, applies what Use is about to do on the server so the UI doesn't wait for a round trip.
+	// Returns false if there was nothing to predict.
+	virtual bool PredictUse(class ASurvivalCharacter* Character, FPredictedItemUse& Prediction);
+
+	// Undoes PredictUse once the server has rejected the use.
+	virtual void RevertPredictedUse(class ASurvivalCharacter* Character, const FPredictedItemUse& Prediction);
 	virtual void AddToInventory(class UInventoryComponent* Inventory);
 
 	void SetQuantity(const int32 NewQuantity);
 
+	// Puts the item back the way NewObject would have made it, before it goes into the item pool.
+	virtual void ResetForReuse();
+
 	void MarkDirtyForReplication();
 
 	UFUNCTION()
@@ -100,5 +141,18 @@ public:
 
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Pickup")
 	TSubclassOf<class APickup> PickupClass;
+
+	// Cells taken up in a grid inventory, before rotation.
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Item", meta = (ClampMin = 1))
+	FIntPoint GridSize;
+
+	// Top left cell in a grid inventory, -1 in any other inventory.
+	UPROPERTY(Replicated, BlueprintReadOnly, Category = "Item")
+	FIntPoint GridPosition;
+
+	UPROPERTY(Replicated, BlueprintReadOnly, Category = "Item")
+	bool bGridRotated;
+
+	FORCEINLINE FIntPoint GetGridFootprint() const { return bGridRotated ? FIntPoint(GridSize.Y, GridSize.X) : GridSize; }
 	
 };
@@ -0,0 +1,160 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Items/ItemPoolSubsystem.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+
+#include "Items/Item.h"
+
+DECLARE_STATS_GROUP(TEXT("ItemPool"), STATGROUP_ItemPool, STATCAT_Advanced);
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Pooled Items"), STAT_ItemPoolNumPooled, STATGROUP_ItemPool);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Items Created"), STAT_ItemPoolNumCreated, STATGROUP_ItemPool);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Items Reused"), STAT_ItemPoolNumReused, STATGROUP_ItemPool);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Items Collected"), STAT_ItemPoolNumCollected, STATGROUP_ItemPool);
+
+static int32 GItemPool = 1;
+static FAutoConsoleVariableRef CVarItemPool(
+	TEXT("inventory.ItemPool"),
+	GItemPool,
+	TEXT("Reuse released item instances instead of leaving them to the garbage collector."));
+
+// Process wide, items don't reliably know their world by the time they're destroyed.
+static int32 GItemsCreated = 0;
+static int32 GItemsReused = 0;
+static int32 GItemsCollected = 0;
+
+static const ERenameFlags ItemPoolRenameFlags = REN_DontCreateRedirectors | REN_NonTransactional | REN_DoNotDirty | REN_ForceNoResetLoaders;
+
+UItemPoolSubsystem::UItemPoolSubsystem()
+	:MaxPooledPerClass(64),
+	NumPooled(0),
+	TimeSinceSample(0.f)
+{
+}
+
+bool UItemPoolSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	if (!Super::ShouldCreateSubsystem(Outer))
+		return false;
+
+	const UWorld* World = Cast<UWorld>(Outer);
+	return World && (World->WorldType == EWorldType::Game || World->WorldType == EWorldType::PIE);
+}
+
+void UItemPoolSubsystem::Deinitialize()
+{
+	Pool.Empty();
+	NumPooled = 0;
+
+	Super::Deinitialize();
+}
+
+void UItemPoolSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	TimeSinceSample += DeltaTime;
+
+	if (TimeSinceSample < 60.f)
+		return;
+
+	TimeSinceSample = 0.f;
+
+	Stats.ItemsCreatedPerMinute = GItemsCreated;
+	Stats.ItemsReusedPerMinute = GItemsReused;
+	Stats.ItemsCollectedPerMinute = GItemsCollected;
+	Stats.NumPooled = NumPooled;
+
+	GItemsCreated = 0;
+	GItemsReused = 0;
+	GItemsCollected = 0;
+
+	UE_LOG(LogTemp, Verbose, TEXT("Item pool: %d created, %d reused, %d collected in the last minute, %d pooled"),
+		Stats.ItemsCreatedPerMinute, Stats.ItemsReusedPerMinute, Stats.ItemsCollectedPerMinute, Stats.NumPooled);
+}
+
+TStatId UItemPoolSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UItemPoolSubsystem, STATGROUP_Tickables);
+}
+
+UItem* UItemPoolSubsystem::AcquireItem(UObject* Outer, TSubclassOf<UItem> ItemClass)
+{
+	if (!ItemClass)
+		return nullptr;
+
+	UWorld* World = Outer ? Outer->GetWorld() : nullptr;
+
+	if (UItemPoolSubsystem* ItemPool = World ? World->GetSubsystem<UItemPoolSubsystem>() : nullptr)
+		return ItemPool->Acquire(Outer, ItemClass);
+
+	++GItemsCreated;
+	INC_DWORD_STAT(STAT_ItemPoolNumCreated);
+
+	return NewObject<UItem>(Outer, ItemClass);
+}
+
+void UItemPoolSubsystem::ReleaseItem(UItem* Item)
+{
+	UWorld* World = Item ? Item->GetWorld() : nullptr;
+
+	if (UItemPoolSubsystem* ItemPool = World ? World->GetSubsystem<UItemPoolSubsystem>() : nullptr)
+		ItemPool->Release(Item);
+}
+
+void UItemPoolSubsystem::NotifyItemDestroyed()
+{
+	++GItemsCollected;
+	INC_DWORD_STAT(STAT_ItemPoolNumCollected);
+}
+
+UItem* UItemPoolSubsystem::Acquire(UObject* Outer, TSubclassOf<UItem> ItemClass)
+{
+	FItemPoolBucket* Bucket = GItemPool ? Pool.Find(ItemClass) : nullptr;
+
+	if (!Bucket || Bucket->Items.Num() == 0)
+	{
+		++GItemsCreated;
+		INC_DWORD_STAT(STAT_ItemPoolNumCreated);
+
+		return NewObject<UItem>(Outer, ItemClass);
+	}
+
+	UItem* Item = Bucket->Items.Pop(false);
+	--NumPooled;
+
+	Item->Rename(nullptr, Outer, ItemPoolRenameFlags);
+
+	++GItemsReused;
+	INC_DWORD_STAT(STAT_ItemPoolNumReused);
+	SET_DWORD_STAT(STAT_ItemPoolNumPooled, NumPooled);
+
+	return Item;
+}
+
+void UItemPoolSubsystem::Release(UItem* Item)
+{
+	if (!GItemPool || !IsValid(Item))
+		return;
+
+	// Anything still in an inventory is referenced by it, and by now probably replicated too.
+	if (!ensure(!Item->OwningInventory))
+		return;
+
+	FItemPoolBucket& Bucket = Pool.FindOrAdd(Item->GetClass());
+
+	if (Bucket.Items.Num() >= MaxPooledPerClass)
+		return;
+
+	Item->ResetForReuse();
+
+	// Parked under the pool so it doesn't keep its old outer alive, or go with it.
+	Item->Rename(nullptr, this, ItemPoolRenameFlags);
+
+	Bucket.Items.Add(Item);
+	++NumPooled;
+
+	SET_DWORD_STAT(STAT_ItemPoolNumPooled, NumPooled);
+}
@@ -0,0 +1,94 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ItemPoolSubsystem.generated.h"
+
+USTRUCT()
+struct FItemPoolBucket
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY()
+	TArray<class UItem*> Items;
+};
+
+// Item allocation counts over the last full minute, for comparing runs with inventory.ItemPool on and off.
+USTRUCT(BlueprintType)
+struct FItemPoolStats
+{
+	GENERATED_BODY()
+
+public:
+	FItemPoolStats()
+		:ItemsCreatedPerMinute(0),
+		ItemsReusedPerMinute(0),
+		ItemsCollectedPerMinute(0),
+		NumPooled(0)
+	{}
+
+	UPROPERTY(BlueprintReadOnly, Category = "Items")
+	int32 ItemsCreatedPerMinute;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Items")
+	int32 ItemsReusedPerMinute;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Items")
+	int32 ItemsCollectedPerMinute;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Items")
+	int32 NumPooled;
+};
+
+/**
+ * Per world pool of item instances keyed by class. Only items that never left the server may be released into it,
+ * anything a client has seen keeps its net GUID and has to go to the garbage collector as usual.
+ */
+UCLASS(Config = Game)
+class SURVIVALGAME_API UItemPoolSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	UItemPoolSubsystem();
+
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Deinitialize() override;
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	// Takes a pooled item of ItemClass if there is one, otherwise makes a new one. Falls back to NewObject when
+	// Outer has no world with a pool.
+	static class UItem* AcquireItem(UObject* Outer, TSubclassOf<class UItem> ItemClass);
+
+	// Item must not be referenced by anything else, or ever have been replicated.
+	static void ReleaseItem(class UItem* Item);
+
+	// Called from UItem::BeginDestroy, counts towards ItemsCollectedPerMinute.
+	static void NotifyItemDestroyed();
+
+	UFUNCTION(BlueprintPure, Category = "Items")
+	FORCEINLINE FItemPoolStats GetPoolStats() const { return Stats; }
+
+protected:
+
+	UPROPERTY(Config)
+	int32 MaxPooledPerClass;
+
+private:
+
+	class UItem* Acquire(UObject* Outer, TSubclassOf<class UItem> ItemClass);
+	void Release(class UItem* Item);
+
+	UPROPERTY()
+	TMap<UClass*, FItemPoolBucket> Pool;
+
+	int32 NumPooled;
+
+	FItemPoolStats Stats;
+	float TimeSinceSample;
+};
@@ -0,0 +1,58 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Items/ItemTagBits.h"
+
+#include "Items/Item.h"
+
+FItemTagBits& FItemTagBits::Get()
+{
+	static FItemTagBits TagBits;
+	return TagBits;
+}
+
+int32 FItemTagBits::FindTagIndex(const FGameplayTag& Tag) const
+{
+	const int32* Index = TagIndices.Find(Tag);
+	return Index ? *Index : INDEX_NONE;
+}
+
+const TBitArray<>& FItemTagBits::GetClassBits(const UClass* ItemClass)
+{
+	if (const TBitArray<>* ExistingBits = ClassBits.Find(ItemClass))
+		return *ExistingBits;
+
+	TBitArray<> Bits;
+
+	// Parents are included so a query for Item.Food matches an item tagged Item.Food.Meat.
+	if (const UItem* DefaultItem = ItemClass ? Cast<UItem>(ItemClass->GetDefaultObject()) : nullptr)
+	{
+		for (const FGameplayTag& Tag : DefaultItem->ItemTags.GetGameplayTagParents())
+		{
+			const int32 Index = FindOrAddTagIndex(Tag);
+
+			if (Bits.Num() <= Index)
+				Bits.Add(false, Index + 1 - Bits.Num());
+
+			Bits[Index] = true;
+		}
+	}
+
+	return ClassBits.Add(ItemClass, MoveTemp(Bits));
+}
+
+bool FItemTagBits::ClassHasTag(const UClass* ItemClass, const FGameplayTag& Tag)
+{
+	const TBitArray<>& Bits = GetClassBits(ItemClass);
+	const int32 TagIndex = FindTagIndex(Tag);
+
+	return Bits.IsValidIndex(TagIndex) && Bits[TagIndex];
+}
+
+int32 FItemTagBits::FindOrAddTagIndex(const FGameplayTag& Tag)
+{
+	if (const int32* Index = TagIndices.Find(Tag))
+		return *Index;
+
+	return TagIndices.Add(Tag, TagIndices.Num());
+}
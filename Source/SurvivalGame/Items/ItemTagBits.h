@@ -0,0 +1,35 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameplayTagContainer.h"
+#include "UObject/ObjectKey.h"
+
+/**
+ * Gives every gameplay tag an item class uses a dense bit index, and compiles each item class's ItemTags, parent tags
+ * included, into a bitset over those indices the first time the class is asked for. Game thread only.
+ */
+class SURVIVALGAME_API FItemTagBits
+{
+public:
+	static FItemTagBits& Get();
+
+	// INDEX_NONE if no item class compiled so far has the tag, so nothing can match it yet.
+	int32 FindTagIndex(const FGameplayTag& Tag) const;
+
+	// Only valid until the next class is compiled.
+	const TBitArray<>& GetClassBits(const UClass* ItemClass);
+
+	// Compiles ItemClass first, so unlike FindTagIndex it is right for a class nothing has asked about yet.
+	bool ClassHasTag(const UClass* ItemClass, const FGameplayTag& Tag);
+
+	int32 GetNumTags() const { return TagIndices.Num(); }
+
+private:
+
+	int32 FindOrAddTagIndex(const FGameplayTag& Tag);
+
+	TMap<FGameplayTag, int32> TagIndices;
+	TMap<FObjectKey, TBitArray<>> ClassBits;
+};
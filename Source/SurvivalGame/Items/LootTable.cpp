@@ -0,0 +1,192 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Items/LootTable.h"
+
+#include "Items/Item.h"
+
+namespace LootTable
+{
+	// Guards against tables that nest each other.
+	static constexpr int32 MaxNestingDepth = 8;
+}
+
+void FLootAliasSampler::Build(const TArray<float>& Weights)
+{
+	const int32 NumWeights = Weights.Num();
+
+	Probabilities.SetNumUninitialized(NumWeights);
+	Aliases.SetNumUninitialized(NumWeights);
+
+	float TotalWeight = 0.f;
+
+	for (const float Weight : Weights)
+	{
+		TotalWeight += FMath::Max(Weight, 0.f);
+	}
+
+	if (NumWeights == 0 || TotalWeight <= 0.f)
+	{
+		Probabilities.Empty();
+		Aliases.Empty();
+		return;
+	}
+
+	TArray<int32> Small;
+	TArray<int32> Large;
+
+	for (int32 i = 0; i < NumWeights; ++i)
+	{
+		Probabilities[i] = FMath::Max(Weights[i], 0.f) * NumWeights / TotalWeight;
+		Aliases[i] = i;
+
+		if (Probabilities[i] < 1.f)
+			Small.Add(i);
+		else
+			Large.Add(i);
+	}
+
+	while (Small.Num() > 0 && Large.Num() > 0)
+	{
+		const int32 Less = Small.Pop(false);
+		const int32 More = Large.Last();
+
+		Aliases[Less] = More;
+		Probabilities[More] = (Probabilities[More] + Probabilities[Less]) - 1.f;
+
+		if (Probabilities[More] < 1.f)
+		{
+			Large.Pop(false);
+			Small.Add(More);
+		}
+	}
+
+	// Whatever is left is 1 give or take float error.
+	for (const int32 i : Large)
+	{
+		Probabilities[i] = 1.f;
+	}
+
+	for (const int32 i : Small)
+	{
+		Probabilities[i] = 1.f;
+	}
+}
+
+int32 FLootAliasSampler::Sample(const FRandomStream& Stream) const
+{
+	if (IsEmpty())
+		return INDEX_NONE;
+
+	const int32 Column = Stream.RandHelper(Probabilities.Num());
+
+	return Stream.GetFraction() < Probabilities[Column] ? Column : Aliases[Column];
+}
+
+ULootTable::ULootTable()
+	:MinRolls(1),
+	MaxRolls(1),
+	bCompiled(false)
+{
+}
+
+void ULootTable::Compile()
+{
+	check(IsInGameThread());
+
+	if (bCompiled)
+		return;
+
+	// Set before recursing so tables that nest each other don't loop forever.
+	bCompiled = true;
+
+	TArray<float> Weights;
+	Weights.Reserve(Entries.Num());
+
+	for (const FLootTableEntry& Entry : Entries)
+	{
+		Weights.Add(Entry.Weight);
+
+		if (Entry.NestedTable)
+			Entry.NestedTable->Compile();
+	}
+
+	Sampler.Build(Weights);
+}
+
+void ULootTable::Roll(FRandomStream& Stream, TArray<FLootDrop>& OutDrops) const
+{
+	ensureMsgf(bCompiled, TEXT("Loot table %s must be compiled before it is rolled."), *GetName());
+
+	Roll_Internal(Stream, OutDrops, 0);
+}
+
+TArray<FLootDrop> ULootTable::RollLoot(const int32 Seed)
+{
+	Compile();
+
+	FRandomStream Stream(Seed);
+	TArray<FLootDrop> Drops;
+
+	Roll(Stream, Drops);
+
+	return Drops;
+}
+
+void ULootTable::Roll_Internal(FRandomStream& Stream, TArray<FLootDrop>& OutDrops, const int32 Depth) const
+{
+	if (Depth > LootTable::MaxNestingDepth || Sampler.IsEmpty())
+		return;
+
+	const int32 NumRolls = Stream.RandRange(MinRolls, FMath::Max(MinRolls, MaxRolls));
+
+	for (int32 i = 0; i < NumRolls; ++i)
+	{
+		const int32 EntryIndex = Sampler.Sample(Stream);
+
+		if (!Entries.IsValidIndex(EntryIndex))
+			continue;
+
+		const FLootTableEntry& Entry = Entries[EntryIndex];
+
+		if (Entry.NestedTable)
+		{
+			Entry.NestedTable->Roll_Internal(Stream, OutDrops, Depth + 1);
+		}
+		else if (Entry.ItemClass)
+		{
+			const int32 Quantity = Stream.RandRange(Entry.MinQuantity, FMath::Max(Entry.MinQuantity, Entry.MaxQuantity));
+
+			if (Quantity > 0)
+				OutDrops.Emplace(Entry.ItemClass, Quantity);
+		}
+	}
+}
+
+void ULootTable::SplitIntoStacks(TArray<FLootDrop>& Drops)
+{
+	TArray<FLootDrop> Stacks;
+	Stacks.Reserve(Drops.Num());
+
+	for (const FLootDrop& Drop : Drops)
+	{
+		const UItem* ItemCDO = Drop.ItemClass->GetDefaultObject<UItem>();
+		const int32 StackSize = ItemCDO->bIsStackable ? FMath::Max(ItemCDO->MaxStackSize, 1) : 1;
+
+		for (int32 Remaining = Drop.Quantity; Remaining > 0; Remaining -= StackSize)
+		{
+			Stacks.Emplace(Drop.ItemClass, FMath::Min(Remaining, StackSize));
+		}
+	}
+
+	Drops = MoveTemp(Stacks);
+}
+
+#if WITH_EDITOR
+void ULootTable::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	bCompiled = false;
+}
+#endif
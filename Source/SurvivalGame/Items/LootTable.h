@@ -0,0 +1,115 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "LootTable.generated.h"
+
+USTRUCT(BlueprintType)
+struct FLootTableEntry
+{
+	GENERATED_BODY()
+
+public:
+	FLootTableEntry()
+		:ItemClass(nullptr),
+		NestedTable(nullptr),
+		Weight(1.f),
+		MinQuantity(1),
+		MaxQuantity(1)
+	{}
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Loot")
+	TSubclassOf<class UItem> ItemClass;
+
+	// Rolled in place of ItemClass when set. An entry with neither rolls nothing.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Loot")
+	class ULootTable* NestedTable;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Loot", meta = (ClampMin = 0.0f))
+	float Weight;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Loot", meta = (ClampMin = 1))
+	int32 MinQuantity;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Loot", meta = (ClampMin = 1))
+	int32 MaxQuantity;
+};
+
+USTRUCT(BlueprintType)
+struct FLootDrop
+{
+	GENERATED_BODY()
+
+public:
+	FLootDrop() : ItemClass(nullptr), Quantity(0) {};
+	FLootDrop(TSubclassOf<class UItem> InItemClass, const int32 InQuantity) : ItemClass(InItemClass), Quantity(InQuantity) {};
+
+	UPROPERTY(BlueprintReadOnly, Category = "Loot")
+	TSubclassOf<class UItem> ItemClass;
+
+	// Not clamped to the item's stack size, whoever spawns the drop splits it into stacks.
+	UPROPERTY(BlueprintReadOnly, Category = "Loot")
+	int32 Quantity;
+};
+
+// Walker/Vose alias table, picks a weighted entry in O(1).
+struct FLootAliasSampler
+{
+	TArray<float> Probabilities;
+	TArray<int32> Aliases;
+
+	void Build(const TArray<float>& Weights);
+
+	int32 Sample(const FRandomStream& Stream) const;
+
+	bool IsEmpty() const { return Probabilities.Num() == 0; }
+};
+
+/**
+ * Weighted loot table. Once compiled, rolling only reads immutable data so batches of rolls can run off the game thread.
+ */
+UCLASS(BlueprintType)
+class SURVIVALGAME_API ULootTable : public UDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	ULootTable();
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Loot")
+	TArray<FLootTableEntry> Entries;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Loot", meta = (ClampMin = 0))
+	int32 MinRolls;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Loot", meta = (ClampMin = 0))
+	int32 MaxRolls;
+
+	// Builds the sampler for this table and every nested table. Game thread only.
+	void Compile();
+
+	bool IsCompiled() const { return bCompiled; }
+
+	// Thread safe once compiled.
+	void Roll(FRandomStream& Stream, TArray<FLootDrop>& OutDrops) const;
+
+	UFUNCTION(BlueprintCallable, Category = "Loot")
+	TArray<FLootDrop> RollLoot(const int32 Seed);
+
+	// Splits drops into stacks no bigger than each item's MaxStackSize. Thread safe.
+	static void SplitIntoStacks(TArray<FLootDrop>& Drops);
+
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(struct FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+
+private:
+
+	void Roll_Internal(FRandomStream& Stream, TArray<FLootDrop>& OutDrops, const int32 Depth) const;
+
+	FLootAliasSampler Sampler;
+
+	bool bCompiled;
+};
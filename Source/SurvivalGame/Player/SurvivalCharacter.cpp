@@ -6,18 +6,91 @@
 #include "Components/CapsuleComponent.h"
 #include "Containers/Map.h"
 #include "Materials/MaterialInstance.h"
+#include "Net/UnrealNetwork.h"
+#include "Engine/NetSerialization.h"
+#include "GameFramework/GameStateBase.h"
 
 #include "Components/InteractionComponent.h"
 #include "Components/InventoryComponent.h"
 #include "Items/Item.h"
 #include "World/Pickup.h"
+#include "World/LootBag.h"
+#include "World/LootContainer.h"
 #include "Items/EquippableItem.h"
 #include "Items/GearItem.h"
+#include "Items/GearAppearanceSubsystem.h"
+#include "Player/SurvivalPlayerController.h"
+#include "Components/InventoryJournal.h"
+#include "World/InteractionSubsystem.h"
+#include "World/SurvivalStatsSubsystem.h"
+
+static_assert(FEquipmentAppearance::NumSlots <= 16, "FEquipmentAppearance::ChangedSlotMask is too small for EEquippableSlot");
+
+// What a connection was last sent, so the next update can skip every slot that hasn't changed since.
+class FEquipmentAppearanceDeltaState : public INetDeltaBaseState
+{
+public:
+	uint8 GearIds[FEquipmentAppearance::NumSlots];
+
+	virtual bool IsStateEqual(INetDeltaBaseState* OtherState) override
+	{
+		const FEquipmentAppearanceDeltaState* Other = static_cast<const FEquipmentAppearanceDeltaState*>(OtherState);
+		return FMemory::Memcmp(GearIds, Other->GearIds, sizeof(GearIds)) == 0;
+	}
+};
+
+bool FEquipmentAppearance::NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms)
+{
+	if (DeltaParms.Writer)
+	{
+		// Without an old state the client still has the default, empty slots.
+		const FEquipmentAppearanceDeltaState* OldState = static_cast<const FEquipmentAppearanceDeltaState*>(DeltaParms.OldState);
+		uint16 ChangedMask = 0;
+
+		for (int32 SlotIndex = 0; SlotIndex < NumSlots; ++SlotIndex)
+		{
+			if (GearIds[SlotIndex] != (OldState ? OldState->GearIds[SlotIndex] : 0))
+				ChangedMask |= 1 << SlotIndex;
+		}
+
+		if (OldState && ChangedMask == 0)
+			return false;
+
+		TSharedPtr<FEquipmentAppearanceDeltaState> NewState = MakeShared<FEquipmentAppearanceDeltaState>();
+		FMemory::Memcpy(NewState->GearIds, GearIds, sizeof(GearIds));
+		*DeltaParms.NewState = NewState;
+
+		FBitWriter& Writer = *DeltaParms.Writer;
+		Writer.SerializeBits(&ChangedMask, NumSlots);
+
+		for (int32 SlotIndex = 0; SlotIndex < NumSlots; ++SlotIndex)
+		{
+			if (ChangedMask & (1 << SlotIndex))
+				Writer << GearIds[SlotIndex];
+		}
+	}
+	else if (DeltaParms.Reader)
+	{
+		FBitReader& Reader = *DeltaParms.Reader;
+
+		ChangedSlotMask = 0;
+		Reader.SerializeBits(&ChangedSlotMask, NumSlots);
+
+		for (int32 SlotIndex = 0; SlotIndex < NumSlots; ++SlotIndex)
+		{
+			if (ChangedSlotMask & (1 << SlotIndex))
+				Reader << GearIds[SlotIndex];
+		}
+	}
+
+	return true;
+}
 
 
 // Sets default values
 ASurvivalCharacter::ASurvivalCharacter()
-	: InteractionCheckFrequency(0.f), InteractionCheckDistance(450.f)
+	: InteractionCheckFrequency(0.f), InteractionCheckDistance(450.f), PredictedPickupTimeout(2.f), LastItemUsePredictionKey(0),
+	InteractionHandle(0)
 {
 	PrimaryActorTick.bCanEverTick = true;
 
@@ -38,42 +111,196 @@ void ASurvivalCharacter::BeginPlay()
 	{
 		BareMesh.Add(PlayerMesh.Key, PlayerMesh.Value->SkeletalMesh);
 	}
-	
+
+	if (!HasAuthority() && PlayerInventory)
+		PlayerInventory->OnInventoryUpdated.AddDynamic(this, &ASurvivalCharacter::OnPlayerInventoryUpdated);
+
+	if (UInteractionSubsystem* InteractionSubsystem = GetWorld()->GetSubsystem<UInteractionSubsystem>())
+		InteractionSubsystem->RegisterInteractor(this);
+
+	if (USurvivalStatsSubsystem* SurvivalStatsSubsystem = HasAuthority() ? GetWorld()->GetSubsystem<USurvivalStatsSubsystem>() : nullptr)
+		SurvivalStatsSubsystem->RegisterCharacter(this);
+}
+
+void ASurvivalCharacter::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (USurvivalStatsSubsystem* SurvivalStatsSubsystem = GetWorld()->GetSubsystem<USurvivalStatsSubsystem>())
+		SurvivalStatsSubsystem->UnregisterCharacter(this);
+
+	Super::EndPlay(EndPlayReason);
+}
+
+float ASurvivalCharacter::GetSurvivalStat(const ESurvivalStat Stat) const
+{
+	if (Stat >= ESurvivalStat::SS_MAX)
+		return 0.f;
+
+	if (HasAuthority())
+	{
+		if (const USurvivalStatsSubsystem* SurvivalStatsSubsystem = GetWorld()->GetSubsystem<USurvivalStatsSubsystem>())
+			return SurvivalStatsSubsystem->GetStat(this, Stat);
+	}
+
+	// Maximums are config, so the class default has the same ones as the server.
+	return SurvivalStats.Values[(int32)Stat] / 255.f * GetDefault<USurvivalStatsSubsystem>()->GetMaxValue(Stat);
+}
+
+void ASurvivalCharacter::SetSurvivalStats(const FQuantizedSurvivalStats& NewStats)
+{
+	if (SurvivalStats == NewStats)
+		return;
+
+	SurvivalStats = NewStats;
+
+	if (IsLocallyControlled())
+		OnSurvivalStatsUpdated();
+}
+
+void ASurvivalCharacter::OnRep_SurvivalStats()
+{
+	OnSurvivalStatsUpdated();
+}
+
+float FInteractionProgress::GetPercentage(const UWorld* World) const
+{
+	if (!Interactable || !World || Duration <= 0.f)
+		return 0.f;
+
+	const AGameStateBase* GameState = World->GetGameState();
+	const double Now = GameState ? GameState->GetServerWorldTimeSeconds() : World->GetTimeSeconds();
+
+	return FMath::Clamp((float)((Now - StartTime) / Duration), 0.f, 1.f);
 }
 
 bool ASurvivalCharacter::IsInteracting() const
 {
-	return GetWorldTimerManager().IsTimerActive(TimerHandle_Interact);
+	return InteractionProgress.Interactable != nullptr;
 }
 
-float ASurvivalCharacter::GetRemainingInerteractTime() const
+void ASurvivalCharacter::StartInteractionProgress()
 {
-	return GetWorldTimerManager().GetTimerRemaining(TimerHandle_Interact);
+	const AGameStateBase* GameState = GetWorld()->GetGameState();
+
+	InteractionProgress.Interactable = GetInteractable();
+	InteractionProgress.StartTime = GameState ? (float)GameState->GetServerWorldTimeSeconds() : GetWorld()->GetTimeSeconds();
+	InteractionProgress.Duration = GetInteractable()->InteractionTime;
+
+	if (UInteractionSubsystem* InteractionSubsystem = GetWorld()->GetSubsystem<UInteractionSubsystem>())
+		InteractionHandle = InteractionSubsystem->StartInteraction(this, InteractionProgress.Duration);
+}
+
+void ASurvivalCharacter::ClearInteractionProgress()
+{
+	// The subsystem still holds the old handle, it just won't match anymore.
+	InteractionProgress = FInteractionProgress();
+	InteractionHandle = 0;
+}
+
+void ASurvivalCharacter::OnInteractionTimeReached(const int32 Handle)
+{
+	if (Handle != 0 && Handle == InteractionHandle)
+		Interact();
+}
+
+void ASurvivalCharacter::OnRep_InteractionProgress(const FInteractionProgress& OldProgress)
+{
+	if (OldProgress.Interactable == InteractionProgress.Interactable)
+		return;
+
+	if (OldProgress.Interactable)
+		OldProgress.Interactable->SetRemoteInteractor(this, false);
+
+	if (InteractionProgress.Interactable)
+		InteractionProgress.Interactable->SetRemoteInteractor(this, true);
 }
 
 // USE
-void ASurvivalCharacter::UseItem(UItem* Item)
+bool ASurvivalCharacter::UseItem(UItem* Item)
+{
+	if (!Item || (PlayerInventory && !PlayerInventory->FindItem(Item)))
+		return false;
+
+	if (!HasAuthority())
+	{
+		FPredictedItemUse Prediction;
+		Prediction.Item = Item;
+
+		if (Item->PredictUse(this, Prediction))
+		{
+			Prediction.PredictionKey = ++LastItemUsePredictionKey;
+			PredictedItemUses.Add(Prediction);
+
+			if (PlayerInventory)
+				PlayerInventory->OnInventoryUpdated.Broadcast();
+		}
+
+		// The server has the final say, clients only know the use was sent.
+		ServerUseitem(Item, Prediction.PredictionKey);
+		return true;
+	}
+
+	return Item->Use(this);
+}
+
+void ASurvivalCharacter::ServerUseitem_Implementation(UItem* Item, const int32 PredictionKey)
 {
-	if (!HasAuthority() && Item)
-		ServerUseitem(Item);
+	if (!ConsumeRpcToken(ERateLimitedRpc::RLR_UseItem))
+	{
+		if (PredictionKey != 0)
+			ClientRejectItemUse(PredictionKey);
 
-	if (PlayerInventory && !PlayerInventory->FindItem(Item))
 		return;
+	}
 
-	if (Item)
+	// FindItem only matches on class, so make sure this exact item is ours before using it.
+	if (!Item || Item->OwningInventory != PlayerInventory)
 	{
-		Item->Use(this);
+		RejectRpc(ERateLimitedRpc::RLR_UseItem);
+
+		if (PredictionKey != 0)
+			ClientRejectItemUse(PredictionKey);
+
+		return;
 	}
+
+	const bool bUsed = UseItem(Item);
+
+	if (PredictionKey == 0)
+		return;
+
+	if (bUsed)
+		ClientConfirmItemUse(PredictionKey);
+	else
+		ClientRejectItemUse(PredictionKey);
 }
 
-void ASurvivalCharacter::ServerUseitem_Implementation(UItem* Item)
+bool ASurvivalCharacter::ServerUseitem_Validate(UItem* Item, const int32 PredictionKey)
 {
-	UseItem(Item);
+	return !IsAbusingRpcs();
 }
 
-bool ASurvivalCharacter::ServerUseitem_Validate(UItem* Item)
+void ASurvivalCharacter::ClientConfirmItemUse_Implementation(const int32 PredictionKey)
 {
-	return true;
+	// The server's state replicates on its own, and already matches what we predicted.
+	PredictedItemUses.RemoveAll([PredictionKey](const FPredictedItemUse& Prediction) { return Prediction.PredictionKey == PredictionKey; });
+}
+
+void ASurvivalCharacter::ClientRejectItemUse_Implementation(const int32 PredictionKey)
+{
+	const int32 Index = PredictedItemUses.IndexOfByPredicate([PredictionKey](const FPredictedItemUse& Prediction) { return Prediction.PredictionKey == PredictionKey; });
+
+	if (Index == INDEX_NONE)
+		return;
+
+	// Nothing changed on the server so nothing will replicate, we have to put the item back ourselves.
+	const FPredictedItemUse Prediction = PredictedItemUses[Index];
+	PredictedItemUses.RemoveAt(Index);
+
+	if (Prediction.Item)
+		Prediction.Item->RevertPredictedUse(this, Prediction);
+
+	if (PlayerInventory)
+		PlayerInventory->OnInventoryUpdated.Broadcast();
 }
 
 // Drop
@@ -88,6 +315,8 @@ void ASurvivalCharacter::DropItem(UItem* Item, const int32 Quantity)
 		return;
 	}
 
+	FInventoryJournal::Record(PlayerInventory, EInventoryJournalOp::Drop, Item, Quantity);
+
 	const int32 ItemQuantity = Item->GetQuantity();
 	const int32 DroppedQuantity = PlayerInventory->ConsumeItem(Item, Quantity);
 
@@ -96,18 +325,299 @@ void ASurvivalCharacter::DropItem(UItem* Item, const int32 Quantity)
 	SpawnParams.bNoFail = true;
 	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
 
-	FVector SpawnLocation = GetActorLocation();
-	SpawnLocation.Z = GetCapsuleComponent()->GetScaledCapsuleHalfHeight(); // Move to feet
-
-	FTransform SpawnTransform(GetActorRotation(), SpawnLocation);
-
 	ensure(PickupClass);
 
-	APickup* Pickup = GetWorld()->SpawnActor<APickup>(PickupClass, SpawnTransform, SpawnParams);
+	APickup* Pickup = GetWorld()->SpawnActor<APickup>(PickupClass, GetDropTransform(), SpawnParams);
 	Pickup->InitPickup(Item->GetClass(), DroppedQuantity);
 	
 }
 
+void ASurvivalCharacter::DropItems(const TArray<UItem*>& ItemsToDrop)
+{
+	if (!PlayerInventory)
+		return;
+
+	if (!HasAuthority())
+	{
+		ServerDropItems(ItemsToDrop);
+		return;
+	}
+
+	TArray<FInventoryItemMove> Moves;
+	TSet<UItem*> UniqueItems;
+
+	for (UItem* Item : ItemsToDrop)
+	{
+		// Equipped items stay on the character.
+		UEquippableItem* EquippableItem = Cast<UEquippableItem>(Item);
+
+		if (!Item || Item->OwningInventory != PlayerInventory || (EquippableItem && EquippableItem->IsEquipped()))
+			continue;
+
+		bool bAlreadyDropping = false;
+		UniqueItems.Add(Item, &bAlreadyDropping);
+
+		if (!bAlreadyDropping)
+			Moves.Add(FInventoryItemMove(Item, nullptr));
+	}
+
+	if (Moves.Num() == 0)
+		return;
+
+	if (Moves.Num() == 1 || !LootBagClass)
+	{
+		for (const FInventoryItemMove& Move : Moves)
+		{
+			DropItem(Move.Item, Move.Item->GetQuantity());
+		}
+
+		return;
+	}
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.Owner = this;
+	SpawnParams.bNoFail = true;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+
+	ALootBag* LootBag = GetWorld()->SpawnActor<ALootBag>(LootBagClass, GetDropTransform(), SpawnParams);
+
+	for (FInventoryItemMove& Move : Moves)
+	{
+		Move.Destination = LootBag->GetBagInventory();
+	}
+
+	FText ErrorText;
+
+	if (!UInventoryComponent::MoveItems(Moves, ErrorText))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("DropItems failed: %s"), *ErrorText.ToString());
+		LootBag->Destroy();
+	}
+}
+
+void ASurvivalCharacter::ServerDropItems_Implementation(const TArray<UItem*>& ItemsToDrop)
+{
+	if (!ConsumeRpcToken(ERateLimitedRpc::RLR_DropItems))
+		return;
+
+	DropItems(ItemsToDrop);
+}
+
+bool ASurvivalCharacter::ServerDropItems_Validate(const TArray<UItem*>& ItemsToDrop)
+{
+	// There can't be more items to drop than fit in the inventory.
+	return !IsAbusingRpcs() && PlayerInventory && ItemsToDrop.Num() <= PlayerInventory->GetCapacity();
+}
+
+void ASurvivalCharacter::TransferItem(UItem* Item, UInventoryComponent* Destination, const int32 Quantity)
+{
+	if (!Item || !Destination)
+		return;
+
+	if (!HasAuthority())
+	{
+		ServerTransferItem(Item, Destination, Quantity);
+		return;
+	}
+
+	if (!CanAccessInventory(Item->OwningInventory) || !CanAccessInventory(Destination))
+		return;
+
+	FText ErrorText;
+
+	if (!UInventoryComponent::MoveItems({ FInventoryItemMove(Item, Destination, Quantity) }, ErrorText))
+		UE_LOG(LogTemp, Warning, TEXT("TransferItem failed: %s"), *ErrorText.ToString());
+}
+
+void ASurvivalCharacter::ServerTransferItem_Implementation(UItem* Item, UInventoryComponent* Destination, const int32 Quantity)
+{
+	if (!ConsumeRpcToken(ERateLimitedRpc::RLR_TransferItem))
+		return;
+
+	if (!Item || !Destination || Item->OwningInventory == Destination)
+	{
+		RejectRpc(ERateLimitedRpc::RLR_TransferItem);
+		return;
+	}
+
+	TransferItem(Item, Destination, Quantity);
+}
+
+bool ASurvivalCharacter::ServerTransferItem_Validate(UItem* Item, UInventoryComponent* Destination, const int32 Quantity)
+{
+	return !IsAbusingRpcs() && Quantity >= 0;
+}
+
+bool ASurvivalCharacter::CanAccessInventory(const UInventoryComponent* Inventory) const
+{
+	if (!Inventory || !Inventory->GetOwner())
+		return false;
+
+	if (Inventory == PlayerInventory)
+		return true;
+
+	// Other players' inventories are off limits, containers have to be within reach.
+	if (Inventory->GetOwner()->IsA<ASurvivalCharacter>())
+		return false;
+
+	// An unopened container can still dematerialize, which would throw away anything put into it.
+	if (const ALootContainer* Container = Cast<ALootContainer>(Inventory->GetOwner()))
+	{
+		if (!Container->HasBeenOpened())
+			return false;
+	}
+
+	return FVector::Dist(GetActorLocation(), Inventory->GetOwner()->GetActorLocation()) <= InteractionCheckDistance;
+}
+
+static int32 GetHeldQuantity(const UInventoryComponent* Inventory, const TSubclassOf<UItem> ItemClass)
+{
+	int32 Quantity = 0;
+
+	if (Inventory)
+	{
+		for (const UItem* Item : Inventory->FindItemsByClass(ItemClass))
+		{
+			Quantity += Item->GetQuantity();
+		}
+	}
+
+	return Quantity;
+}
+
+void ASurvivalCharacter::PredictPickup(APickup* Pickup)
+{
+	if (!Pickup || !Pickup->GetItem())
+		return;
+
+	FPredictedPickup Prediction;
+	Prediction.Pickup = Pickup;
+	Prediction.Item = Pickup->GetItem();
+	Prediction.PredictedTime = GetWorld()->GetTimeSeconds();
+	Prediction.ExpectedItemCount = GetHeldQuantity(PlayerInventory, Prediction.Item->GetClass()) + Prediction.Item->GetQuantity();
+
+	// Earlier pickups of the same class that haven't turned up yet arrive first.
+	for (const FPredictedPickup& EarlierPrediction : PredictedPickups)
+	{
+		if (EarlierPrediction.Item && EarlierPrediction.Item->GetClass() == Prediction.Item->GetClass())
+			Prediction.ExpectedItemCount += EarlierPrediction.Item->GetQuantity();
+	}
+
+	PredictedPickups.Add(Prediction);
+
+	Pickup->SetPredictedTaken(true);
+	Pickup->OnDestroyed.AddUniqueDynamic(this, &ASurvivalCharacter::OnPredictedPickupDestroyed);
+
+	OnPendingPickupsChanged.Broadcast();
+}
+
+void ASurvivalCharacter::ClientRejectPickup_Implementation(APickup* Pickup)
+{
+	const int32 Index = PredictedPickups.IndexOfByPredicate([Pickup](const FPredictedPickup& Prediction) { return Prediction.Pickup == Pickup; });
+
+	if (Index != INDEX_NONE)
+		RestorePredictedPickup(Index);
+}
+
+TArray<UItem*> ASurvivalCharacter::GetPendingPickupItems() const
+{
+	TArray<UItem*> PendingItems;
+
+	for (const FPredictedPickup& Prediction : PredictedPickups)
+	{
+		if (Prediction.Item)
+			PendingItems.Add(Prediction.Item);
+	}
+
+	return PendingItems;
+}
+
+void ASurvivalCharacter::OnPredictedPickupDestroyed(AActor* DestroyedActor)
+{
+	for (FPredictedPickup& Prediction : PredictedPickups)
+	{
+		if (Prediction.Pickup == DestroyedActor || !Prediction.Pickup.IsValid())
+			Prediction.bConfirmed = true;
+	}
+}
+
+void ASurvivalCharacter::OnPlayerInventoryUpdated()
+{
+	// The inventory can replicate before the pickup's destruction does, so an item that has turned up clears its
+	// prediction straight away rather than showing twice until the pickup goes.
+	const int32 NumRemoved = PredictedPickups.RemoveAll([this](const FPredictedPickup& Prediction)
+	{
+		if (Prediction.bConfirmed)
+			return true;
+
+		if (!Prediction.Item || GetHeldQuantity(PlayerInventory, Prediction.Item->GetClass()) < Prediction.ExpectedItemCount)
+			return false;
+
+		// The server has taken the pickup, so it stays hidden until its destruction replicates.
+		if (APickup* Pickup = Prediction.Pickup.Get())
+			Pickup->OnDestroyed.RemoveDynamic(this, &ASurvivalCharacter::OnPredictedPickupDestroyed);
+
+		return true;
+	});
+
+	if (NumRemoved > 0)
+		OnPendingPickupsChanged.Broadcast();
+}
+
+void ASurvivalCharacter::RestorePredictedPickup(const int32 Index)
+{
+	if (APickup* Pickup = PredictedPickups[Index].Pickup.Get())
+	{
+		Pickup->OnDestroyed.RemoveDynamic(this, &ASurvivalCharacter::OnPredictedPickupDestroyed);
+		Pickup->SetPredictedTaken(false);
+	}
+
+	PredictedPickups.RemoveAt(Index);
+	OnPendingPickupsChanged.Broadcast();
+}
+
+void ASurvivalCharacter::TickPredictedPickups()
+{
+	const float TimeoutTime = GetWorld()->GetTimeSeconds() - PredictedPickupTimeout;
+
+	for (int32 Index = PredictedPickups.Num() - 1; Index >= 0; --Index)
+	{
+		const FPredictedPickup& Prediction = PredictedPickups[Index];
+
+		if (Prediction.PredictedTime >= TimeoutTime)
+			continue;
+
+		// A confirmed pickup whose inventory update never came is dropped quietly, the inventory is right either way.
+		if (Prediction.bConfirmed)
+		{
+			PredictedPickups.RemoveAt(Index);
+			OnPendingPickupsChanged.Broadcast();
+		}
+		else
+		{
+			RestorePredictedPickup(Index);
+		}
+	}
+}
+
+bool ASurvivalCharacter::ConsumeRpcToken(const ERateLimitedRpc Rpc) const
+{
+	ASurvivalPlayerController* PlayerController = Cast<ASurvivalPlayerController>(GetController());
+	return !PlayerController || PlayerController->ConsumeRpcToken(Rpc);
+}
+
+void ASurvivalCharacter::RejectRpc(const ERateLimitedRpc Rpc) const
+{
+	if (ASurvivalPlayerController* PlayerController = Cast<ASurvivalPlayerController>(GetController()))
+		PlayerController->NotifyRejectedRpc(Rpc);
+}
+
+bool ASurvivalCharacter::IsAbusingRpcs() const
+{
+	const ASurvivalPlayerController* PlayerController = Cast<ASurvivalPlayerController>(GetController());
+	return PlayerController && PlayerController->IsAbusingRpcs();
+}
+
 bool ASurvivalCharacter::EquipItem(UEquippableItem* Item)
 {
 	EquippedItems.Add(Item->Slot, Item);
@@ -127,18 +637,89 @@ bool ASurvivalCharacter::UnequipItem(UEquippableItem* Item)
 
 void ASurvivalCharacter::EquipGear(UGearItem* Gear)
 {
-	if (USkeletalMeshComponent* GearMesh = *PlayerMeshes.Find(Gear->Slot))
+	if (!Gear)
+		return;
+
+	ApplyGearMesh(Gear->Slot, Gear);
+
+	if (HasAuthority())
+	{
+		const UGearAppearanceSubsystem* GearAppearance = UGearAppearanceSubsystem::Get();
+		const uint8 GearId = GearAppearance ? GearAppearance->GetGearId(Gear->GetClass()) : 0;
+
+		if (GearId == 0)
+			UE_LOG(LogTemp, Warning, TEXT("%s has no gear id, other players won't see it"), *Gear->GetClass()->GetName());
+
+		EquipmentAppearance.GearIds[(uint8)Gear->Slot] = GearId;
+	}
+}
+
+void ASurvivalCharacter::ApplyGearMesh(const EEquippableSlot Slot, const UGearItem* Gear)
+{
+	if (USkeletalMeshComponent* GearMesh = PlayerMeshes.FindRef(Slot))
 	{
 		GearMesh->SetSkeletalMesh(Gear->Mesh);
 		GearMesh->SetMaterial(GearMesh->GetMaterials().Num() - 1, Gear->MaterialInstance);
 	}
 }
 
+void ASurvivalCharacter::OnRep_EquipmentAppearance()
+{
+	for (int32 SlotIndex = 0; SlotIndex < FEquipmentAppearance::NumSlots; ++SlotIndex)
+	{
+		if (!(EquipmentAppearance.ChangedSlotMask & (1 << SlotIndex)))
+			continue;
+
+		const EEquippableSlot Slot = (EEquippableSlot)SlotIndex;
+		const uint8 GearId = EquipmentAppearance.GearIds[SlotIndex];
+		UGearAppearanceSubsystem* GearAppearance = UGearAppearanceSubsystem::Get();
+
+		if (GearId == 0 || !GearAppearance)
+		{
+			UnequipGear(Slot);
+			continue;
+		}
+
+		// Remote players never get the gear items themselves, the class defaults hold everything needed to draw them.
+		if (const TSubclassOf<UGearItem> GearClass = GearAppearance->FindGearClass(GearId))
+		{
+			ApplyGearMesh(Slot, GearClass->GetDefaultObject<UGearItem>());
+		}
+		else
+		{
+			// The slot shows bare until the class has loaded rather than stall the game thread on it.
+			UnequipGear(Slot);
+			GearAppearance->LoadGearClass(GearId, FStreamableDelegate::CreateUObject(this, &ASurvivalCharacter::OnGearClassLoaded, Slot));
+		}
+	}
+}
+
+void ASurvivalCharacter::OnGearClassLoaded(const EEquippableSlot Slot)
+{
+	const UGearAppearanceSubsystem* GearAppearance = UGearAppearanceSubsystem::Get();
+
+	// The slot may have changed again while the class was loading.
+	if (const TSubclassOf<UGearItem> GearClass = GearAppearance ? GearAppearance->FindGearClass(EquipmentAppearance.GearIds[(uint8)Slot]) : nullptr)
+		ApplyGearMesh(Slot, GearClass->GetDefaultObject<UGearItem>());
+}
+
+void ASurvivalCharacter::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME_CONDITION(ASurvivalCharacter, EquipmentAppearance, COND_SkipOwner);
+	DOREPLIFETIME_CONDITION(ASurvivalCharacter, InteractionProgress, COND_SkipOwner);
+	DOREPLIFETIME_CONDITION(ASurvivalCharacter, SurvivalStats, COND_OwnerOnly);
+}
+
 void ASurvivalCharacter::UnequipGear(EEquippableSlot Slot)
 {
-	if (USkeletalMeshComponent* PlayerMesh = *PlayerMeshes.Find(Slot))
+	if (HasAuthority())
+		EquipmentAppearance.GearIds[(uint8)Slot] = 0;
+
+	if (USkeletalMeshComponent* PlayerMesh = PlayerMeshes.FindRef(Slot))
 	{
-		if (USkeletalMesh* BodyMesh = *BareMesh.Find(Slot))
+		if (USkeletalMesh* BodyMesh = BareMesh.FindRef(Slot))
 		{
 			PlayerMesh->SetSkeletalMesh(BodyMesh);
 
@@ -157,12 +738,21 @@ void ASurvivalCharacter::UnequipGear(EEquippableSlot Slot)
 
 void ASurvivalCharacter::ServerDropItem_Implementation(UItem* Item, const int32 Quantity)
 {
+	if (!ConsumeRpcToken(ERateLimitedRpc::RLR_DropItem))
+		return;
+
+	if (!Item || Item->OwningInventory != PlayerInventory || Quantity <= 0)
+	{
+		RejectRpc(ERateLimitedRpc::RLR_DropItem);
+		return;
+	}
+
 	DropItem(Item, Quantity);
 }
 
 bool ASurvivalCharacter::ServerDropItem_Validate(UItem* Item, const int32 Quantity)
 {
-	return true;
+	return !IsAbusingRpcs() && Quantity >= 0;
 }
 
 USkeletalMeshComponent* ASurvivalCharacter::GetSlotSkeletalMeshComp(const EEquippableSlot Slot)
@@ -218,10 +808,8 @@ void ASurvivalCharacter::Tick(float DeltaTime)
 {
 	Super::Tick(DeltaTime);
 
-	const bool bIsIneractingOnServer = (HasAuthority() && IsInteracting());
-
-	if(!HasAuthority() || GetWorld()->TimeSince(InteractionData.LastInteractionCheckTime) > InteractionCheckFrequency)
-		PerformInteractionCheck();
+	if (PredictedPickups.Num() > 0)
+		TickPredictedPickups();
 }
 
 void ASurvivalCharacter::PerformInteractionCheck()
@@ -236,25 +824,49 @@ void ASurvivalCharacter::PerformInteractionCheck()
 	GetController()->GetPlayerViewPoint(EyeLoc, EyeRot);
 	FVector TraceStart = EyeLoc;
 	FVector TraceEnd = (EyeRot.Vector() * InteractionCheckDistance) + TraceStart;
-	
-	InteractionData.LastInteractionCheckTime = GetWorld()->GetTimeSeconds();
 
-	GetController()->GetPlayerViewPoint(EyeLoc, EyeRot);
+	InteractionData.LastInteractionCheckTime = GetWorld()->GetTimeSeconds();
 
 	FCollisionQueryParams QueryParams;
 	QueryParams.AddIgnoredActor(this);
 
-	if (!GetWorld()->LineTraceSingleByChannel(TraceHit, TraceStart, TraceEnd, ECC_Visibility, QueryParams)) {
+	const bool bHit = GetWorld()->LineTraceSingleByChannel(TraceHit, TraceStart, TraceEnd, ECC_Visibility, QueryParams);
+	ApplyInteractionTrace(bHit ? &TraceHit : nullptr, TraceStart);
+}
+
+bool ASurvivalCharacter::GetInteractionTrace(FVector& OutTraceStart, FVector& OutTraceEnd)
+{
+	if (!GetController())
+		return false;
+
+	// Clients check every frame, the server only as often as InteractionCheckFrequency.
+	if (HasAuthority() && GetWorld()->TimeSince(InteractionData.LastInteractionCheckTime) <= InteractionCheckFrequency)
+		return false;
+
+	FVector EyeLoc;
+	FRotator EyeRot;
+	GetController()->GetPlayerViewPoint(EyeLoc, EyeRot);
+	OutTraceStart = EyeLoc;
+	OutTraceEnd = (EyeRot.Vector() * InteractionCheckDistance) + OutTraceStart;
+
+	InteractionData.LastInteractionCheckTime = GetWorld()->GetTimeSeconds();
+
+	return true;
+}
+
+void ASurvivalCharacter::ApplyInteractionTrace(const FHitResult* Hit, const FVector& TraceStart)
+{
+	if (!Hit) {
 		CouldntFindInteractable();
 		return;
 	}
-	else if (!TraceHit.GetActor()) {
+	else if (!Hit->GetActor()) {
 		CouldntFindInteractable();
 		return;
 	}
-	else if (UInteractionComponent* InteractionComp = Cast<UInteractionComponent>(TraceHit.GetActor()->GetComponentByClass(UInteractionComponent::StaticClass())))
+	else if (UInteractionComponent* InteractionComp = Cast<UInteractionComponent>(Hit->GetActor()->GetComponentByClass(UInteractionComponent::StaticClass())))
 	{
-		float DistanceToInteractable = (TraceStart - TraceHit.ImpactPoint).Size();
+		float DistanceToInteractable = (TraceStart - Hit->ImpactPoint).Size();
 
 		if (DistanceToInteractable > InteractionComp->InteractionDistance) {
 			CouldntFindInteractable();
@@ -267,10 +879,7 @@ void ASurvivalCharacter::PerformInteractionCheck()
 
 void ASurvivalCharacter::CouldntFindInteractable()
 {
-	if (GetWorldTimerManager().IsTimerActive(TimerHandle_Interact)) 
-	{
-		GetWorldTimerManager().ClearTimer(TimerHandle_Interact);
-	}
+	ClearInteractionProgress();
 	
 	if (!GetInteractable())
 		return;
@@ -287,11 +896,13 @@ void ASurvivalCharacter::CouldntFindInteractable()
 
 void ASurvivalCharacter::FoundInteractable(UInteractionComponent* Interactable)
 {
-	EndInteract();
-
-	if(!Interactable)
+	// Clients find the same interactable every frame, only a change of focus ends anything.
+	if (!Interactable || Interactable == GetInteractable())
 		return;
 
+	if (InteractionData.bInteractHeld)
+		EndInteract();
+
 	if (GetInteractable())
 	{
 		GetInteractable()->EndFocus(this);
@@ -324,18 +935,18 @@ void ASurvivalCharacter::BeginInteract()
 	}
 	else
 	{
-		GetWorldTimerManager().SetTimer(TimerHandle_Interact, this, &ASurvivalCharacter::Interact, GetInteractable()->InteractionTime, false);
+		StartInteractionProgress();
 	}
 }
 
 void ASurvivalCharacter::EndInteract()
 {
-	if (!HasAuthority())
+	if (!HasAuthority() && InteractionData.bInteractHeld)
 		ServerEndInteract();
 
 	InteractionData.bInteractHeld = false;
 
-	GetWorldTimerManager().ClearTimer(TimerHandle_Interact);
+	ClearInteractionProgress();
 
 	if (!GetInteractable())
 		return;
@@ -346,9 +957,14 @@ void ASurvivalCharacter::EndInteract()
 
 void ASurvivalCharacter::ServerBeginInteract_Implementation()
 {
+	// Beginning an interaction traces on the server, so it is the one most worth limiting.
+	if (!ConsumeRpcToken(ERateLimitedRpc::RLR_BeginInteract))
+		return;
+
 	BeginInteract();
 }
 
+// Not rate limited, a dropped EndInteract would leave the interaction running on the server.
 void ASurvivalCharacter::ServerEndInteract_Implementation()
 {
 	EndInteract();
@@ -356,7 +972,7 @@ void ASurvivalCharacter::ServerEndInteract_Implementation()
 
 bool ASurvivalCharacter::ServerBeginInteract_Validate()
 {
-	return true;
+	return !IsAbusingRpcs();
 }
 
 bool ASurvivalCharacter::ServerEndInteract_Validate()
@@ -366,7 +982,7 @@ bool ASurvivalCharacter::ServerEndInteract_Validate()
 
 void ASurvivalCharacter::Interact()
 {
-	GetWorldTimerManager().ClearTimer(TimerHandle_Interact);
+	ClearInteractionProgress();
 	
 	if (!GetInteractable())
 		return;
@@ -405,6 +1021,7 @@ void ASurvivalCharacter::SetupComps()
 	PlayerInventory = CreateDefaultSubobject<UInventoryComponent>(TEXT("Player Inventory"));
 	PlayerInventory->SetCapacity(Capaciy);
 	PlayerInventory->SetWeightCapacity(CarryWeight);
+	PlayerInventory->SetReplicationPolicy(EInventoryReplicationPolicy::IRP_OwnerOnly);
 
 	HelmetMesh = PlayerMeshes.Add(EEquippableSlot::EIS_Helmet, CreateDefaultSubobject<USkeletalMeshComponent>(TEXT("HelmetMesh")));
 	ChestMesh = PlayerMeshes.Add(EEquippableSlot::EIS_Chest, CreateDefaultSubobject<USkeletalMeshComponent>(TEXT("ChestMesh")));
@@ -425,6 +1042,14 @@ void ASurvivalCharacter::SetupComps()
 	PlayerMeshes.Add(EEquippableSlot::EIS_Head, CreateDefaultSubobject<USkeletalMeshComponent>(TEXT("HeadMesh")));
 }
 
+FTransform ASurvivalCharacter::GetDropTransform() const
+{
+	FVector SpawnLocation = GetActorLocation();
+	SpawnLocation.Z -= GetCapsuleComponent()->GetScaledCapsuleHalfHeight(); // Move to feet
+
+	return FTransform(GetActorRotation(), SpawnLocation);
+}
+
 void ASurvivalCharacter::DrawLookDebug()
 {
 	FVector EyeLoc;
@@ -4,6 +4,8 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Character.h"
+#include "Items/EquippableItem.h"
+#include "World/SurvivalStatsSubsystem.h"
 #include "SurvivalCharacter.generated.h"
 
 USTRUCT()
@@ -29,6 +31,100 @@ public:
 	bool bInteractHeld;
 };
 
+// A timed interaction in progress. Sent once when it starts, anyone can work out how far along it is from that.
+USTRUCT(BlueprintType)
+struct FInteractionProgress
+{
+	GENERATED_BODY()
+
+public:
+	FInteractionProgress()
+		:Interactable(nullptr),
+		StartTime(0.f),
+		Duration(0.f)
+	{}
+
+	// Null when we aren't interacting.
+	UPROPERTY(BlueprintReadOnly, Category = "Interaction")
+	class UInteractionComponent* Interactable;
+
+	// Server world time the interaction started at.
+	UPROPERTY(BlueprintReadOnly, Category = "Interaction")
+	float StartTime;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Interaction")
+	float Duration;
+
+	float GetPercentage(const UWorld* World) const;
+};
+
+// Client side record of a pickup we took before the server agreed.
+USTRUCT()
+struct FPredictedPickup
+{
+	GENERATED_BODY()
+
+public:
+	FPredictedPickup()
+		:Item(nullptr),
+		PredictedTime(0.f),
+		ExpectedItemCount(0),
+		bConfirmed(false)
+	{}
+
+	TWeakObjectPtr<class APickup> Pickup;
+
+	// Kept around after the pickup is gone so the UI can show it until it turns up in the inventory.
+	UPROPERTY()
+	class UItem* Item;
+
+	float PredictedTime;
+
+	// How many of the item's class the inventory holds once this pickup, and any taken before it, have turned up.
+	int32 ExpectedItemCount;
+
+	// The server destroyed the pickup, we're waiting on the inventory to replicate.
+	bool bConfirmed;
+};
+
+// What other players see us wearing, a gear id per slot. Each update only carries the slots that changed
+// since the last state the connection received.
+USTRUCT()
+struct FEquipmentAppearance
+{
+	GENERATED_BODY()
+
+public:
+	static constexpr int32 NumSlots = (int32)EEquippableSlot::EIS_MAX;
+
+	FEquipmentAppearance()
+		:ChangedSlotMask(0)
+	{
+		FMemory::Memzero(GearIds);
+	}
+
+	// Ids from UGearAppearanceSubsystem, 0 for nothing.
+	uint8 GearIds[NumSlots];
+
+	// Client side, the slots the last received update touched.
+	uint16 ChangedSlotMask;
+
+	bool NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms);
+};
+
+template<>
+struct TStructOpsTypeTraits<FEquipmentAppearance> : public TStructOpsTypeTraitsBase2<FEquipmentAppearance>
+{
+	enum
+	{
+		WithNetDeltaSerializer = true
+	};
+};
+
+enum class ERateLimitedRpc : uint8;
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnPendingPickupsChanged);
+
 //Call whenever a EEquippableSlot changes for the player.
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnEquippedItemsChanged, const EEquippableSlot, Slot, const UEquippableItem*, Item);
 
@@ -79,6 +175,7 @@ public:
 protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 	virtual void Tick(float DeltaTime) override;
 
 	UPROPERTY(EditDefaultsOnly, Category = "Interaction")
@@ -87,14 +184,12 @@ protected:
 	UPROPERTY(EditAnywhere, Category = "Interaction")
 	float InteractionCheckDistance;
 
+	// Synchronous, for when the result is needed right away. The regular checks go through the interaction subsystem.
 	void PerformInteractionCheck();
 
 	void CouldntFindInteractable();
 	void FoundInteractable(class UInteractionComponent* Interactable);
 
-	void BeginInteract();
-	void EndInteract();
-
 	UFUNCTION(Server, Reliable, WithValidation)
 	void ServerBeginInteract();
 	UFUNCTION(Server, Reliable, WithValidation)
@@ -107,7 +202,18 @@ protected:
 
 	FORCEINLINE class UInteractionComponent* GetInteractable() const { return InteractionData.ViewedInteractionComponent;  }
 
-	FTimerHandle TimerHandle_Interact;
+	// Only the server's copy matters to other players, we set our own the moment we start.
+	UPROPERTY(ReplicatedUsing = OnRep_InteractionProgress)
+	FInteractionProgress InteractionProgress;
+
+	UFUNCTION()
+	void OnRep_InteractionProgress(const FInteractionProgress& OldProgress);
+
+	void StartInteractionProgress();
+	void ClearInteractionProgress();
+
+	// Handle of our pending interaction in the interaction subsystem, 0 when there isn't one.
+	int32 InteractionHandle;
 
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Inventory")
 	float CarryWeight;
@@ -116,15 +222,34 @@ protected:
 	int32 Capaciy;
 
 public:
+	void BeginInteract();
+	void EndInteract();
+
 	bool IsInteracting() const;
 
-	float GetRemainingInerteractTime() const;
+	FORCEINLINE const FInteractionProgress& GetInteractionProgress() const { return InteractionProgress; }
+
+	// Called by the interaction subsystem once a timed interaction's duration is up.
+	void OnInteractionTimeReached(const int32 Handle);
+
+	// Returns false if we don't want an interaction check this frame.
+	bool GetInteractionTrace(FVector& OutTraceStart, FVector& OutTraceEnd);
+
+	// Hit is null if the trace didn't hit anything.
+	void ApplyInteractionTrace(const FHitResult* Hit, const FVector& TraceStart);
 
 	UFUNCTION(BlueprintCallable, Category = "Items")
-	void UseItem(class UItem* Item);
+	bool UseItem(class UItem* Item);
 
+	// PredictionKey is 0 if the client didn't predict the use, otherwise the server answers with a confirm or reject.
 	UFUNCTION(Server, Reliable, WithValidation)
-	void ServerUseitem(class UItem* Item);
+	void ServerUseitem(class UItem* Item, const int32 PredictionKey);
+
+	UFUNCTION(Client, Reliable)
+	void ClientConfirmItemUse(const int32 PredictionKey);
+
+	UFUNCTION(Client, Reliable)
+	void ClientRejectItemUse(const int32 PredictionKey);
 
 	UFUNCTION(BlueprintCallable, Category = "Items")
 	void DropItem(class UItem* Item, const int32 Quantity);
@@ -132,9 +257,45 @@ public:
 	UFUNCTION(Server, Reliable, WithValidation)
 	void ServerDropItem(class UItem* Item, const int32 Quantity);
 
+	// Drops several items at once into a single loot bag.
+	UFUNCTION(BlueprintCallable, Category = "Items")
+	void DropItems(const TArray<class UItem*>& ItemsToDrop);
+
+	UFUNCTION(Server, Reliable, WithValidation)
+	void ServerDropItems(const TArray<class UItem*>& ItemsToDrop);
+
+	// Moves an item between our inventory and a container we are standing at.
+	UFUNCTION(BlueprintCallable, Category = "Items")
+	void TransferItem(class UItem* Item, class UInventoryComponent* Destination, const int32 Quantity);
+
+	UFUNCTION(Server, Reliable, WithValidation)
+	void ServerTransferItem(class UItem* Item, class UInventoryComponent* Destination, const int32 Quantity);
+
+	bool CanAccessInventory(const class UInventoryComponent* Inventory) const;
+
+	// Client side. Hides a pickup we just took and shows its item as pending until the server answers.
+	void PredictPickup(class APickup* Pickup);
+
+	UFUNCTION(Client, Reliable)
+	void ClientRejectPickup(class APickup* Pickup);
+
+	// Items from predicted pickups that haven't shown up in the inventory yet.
+	UFUNCTION(BlueprintPure, Category = "Items")
+	TArray<class UItem*> GetPendingPickupItems() const;
+
+	UPROPERTY(BlueprintAssignable, Category = "Items")
+	FOnPendingPickupsChanged OnPendingPickupsChanged;
+
+	// Seconds to wait on the server before a predicted pickup is put back.
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Item")
+	float PredictedPickupTimeout;
+
 	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Item")
 	TSubclassOf<class APickup> PickupClass;
 
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Item")
+	TSubclassOf<class ALootBag> LootBagClass;
+
 public:
 	bool EquipItem(class UEquippableItem* Item);
 	bool UnequipItem(class UEquippableItem* Item);
@@ -156,6 +317,19 @@ protected:
 	UPROPERTY(VisibleAnywhere, Category = "Items")
 	TMap<EEquippableSlot, UEquippableItem*> EquippedItems;
 
+	// Our inventory only replicates to us, so this is all other players get to see our gear from.
+	UPROPERTY(ReplicatedUsing = OnRep_EquipmentAppearance)
+	FEquipmentAppearance EquipmentAppearance;
+
+	UFUNCTION()
+	void OnRep_EquipmentAppearance();
+
+	void ApplyGearMesh(const EEquippableSlot Slot, const class UGearItem* Gear);
+
+	void OnGearClassLoaded(const EEquippableSlot Slot);
+
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
 	void MoveForward(float Val);
 	void MoveRight(float Val);
 
@@ -165,6 +339,28 @@ protected:
 	void StartCrouching();
 	void StopCrouching();
 
+public:
+
+	// Exact on the server, the owner's copy is quantized to a byte of the stat's maximum.
+	UFUNCTION(BlueprintPure, Category = "Survival")
+	float GetSurvivalStat(const ESurvivalStat Stat) const;
+
+	// Called by the survival stats subsystem every replication interval.
+	void SetSurvivalStats(const FQuantizedSurvivalStats& NewStats);
+
+	// Called on the owner whenever new stats arrive.
+	UFUNCTION(BlueprintImplementableEvent)
+	void OnSurvivalStatsUpdated();
+
+protected:
+
+	// Simulated by the survival stats subsystem, only the owner gets a copy.
+	UPROPERTY(ReplicatedUsing = OnRep_SurvivalStats)
+	FQuantizedSurvivalStats SurvivalStats;
+
+	UFUNCTION()
+	void OnRep_SurvivalStats();
+
 public:	
 
 	// Called to bind functionality to input
@@ -175,5 +371,30 @@ private:
 
 	void SetupComps();
 
+	FTransform GetDropTransform() const;
+
+	// Uses we applied locally and are waiting on the server for, oldest first.
+	UPROPERTY()
+	TArray<FPredictedItemUse> PredictedItemUses;
+
+	int32 LastItemUsePredictionKey;
+
+	UPROPERTY()
+	TArray<FPredictedPickup> PredictedPickups;
+
+	UFUNCTION()
+	void OnPredictedPickupDestroyed(AActor* DestroyedActor);
+
+	UFUNCTION()
+	void OnPlayerInventoryUpdated();
+
+	void RestorePredictedPickup(const int32 Index);
+	void TickPredictedPickups();
+
+	// Server side gates for our RPCs, run before any traces, spawns or inventory scans.
+	bool ConsumeRpcToken(const ERateLimitedRpc Rpc) const;
+	void RejectRpc(const ERateLimitedRpc Rpc) const;
+	bool IsAbusingRpcs() const;
+
 	void DrawLookDebug();
 };
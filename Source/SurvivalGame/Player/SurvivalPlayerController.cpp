@@ -2,4 +2,102 @@
 
 
 #include "Player/SurvivalPlayerController.h"
+#include "Engine/World.h"
+#include "Misc/CommandLine.h"
 
+#include "Framework/LoadTestBot.h"
+
+DECLARE_STATS_GROUP(TEXT("RpcRateLimit"), STATGROUP_RpcRateLimit, STATCAT_Advanced);
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Dropped RPCs"), STAT_RpcDropped, STATGROUP_RpcRateLimit);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Rejected RPCs"), STAT_RpcRejected, STATGROUP_RpcRateLimit);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Abusive Connections"), STAT_RpcAbusiveConnections, STATGROUP_RpcRateLimit);
+
+ASurvivalPlayerController::ASurvivalPlayerController()
+	:KickViolationThreshold(100),
+	ViolationWindow(10.f),
+	LoadTestBot(nullptr),
+	NumDroppedRpcs(0),
+	WindowViolations(0),
+	ViolationWindowStart(0.0),
+	bAbusingRpcs(false)
+{
+}
+
+void ASurvivalPlayerController::PostInitializeComponents()
+{
+	Super::PostInitializeComponents();
+
+	for (const FRpcRateLimit& Limit : RpcRateLimits)
+	{
+		if (Limit.Rpc == ERateLimitedRpc::RLR_MAX)
+			continue;
+
+		FTokenBucket& Bucket = RpcBuckets[(uint8)Limit.Rpc];
+		Bucket.TokensPerSecond = Limit.TokensPerSecond;
+		Bucket.BurstSize = Limit.BurstSize;
+		Bucket.Tokens = Limit.BurstSize;
+	}
+}
+
+void ASurvivalPlayerController::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (IsLocalController() && FParse::Param(FCommandLine::Get(), TEXT("LoadTestBot")))
+		LoadTestBot = NewObject<ULoadTestBot>(this);
+}
+
+void ASurvivalPlayerController::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	if (LoadTestBot)
+		LoadTestBot->TickBot(this, DeltaTime);
+}
+
+bool ASurvivalPlayerController::ConsumeRpcToken(const ERateLimitedRpc Rpc)
+{
+	FTokenBucket& Bucket = RpcBuckets[(uint8)Rpc];
+
+	if (Bucket.BurstSize <= 0.f)
+		return true;
+
+	const double Now = GetWorld()->GetRealTimeSeconds();
+
+	Bucket.Tokens = FMath::Min(Bucket.BurstSize, Bucket.Tokens + (float)(Now - Bucket.LastRefillTime) * Bucket.TokensPerSecond);
+	Bucket.LastRefillTime = Now;
+
+	if (Bucket.Tokens >= 1.f)
+	{
+		Bucket.Tokens -= 1.f;
+		return true;
+	}
+
+	++NumDroppedRpcs;
+	INC_DWORD_STAT(STAT_RpcDropped);
+
+	// A lagging client can legitimately burst, only a sustained flood is treated as abuse.
+	if (Now - ViolationWindowStart > ViolationWindow)
+	{
+		ViolationWindowStart = Now;
+		WindowViolations = 0;
+	}
+
+	if (++WindowViolations > KickViolationThreshold && !bAbusingRpcs)
+	{
+		bAbusingRpcs = true;
+		INC_DWORD_STAT(STAT_RpcAbusiveConnections);
+
+		UE_LOG(LogTemp, Warning, TEXT("%s exceeded the RPC rate limit %i times in %.1fs, disconnecting"), *GetName(), WindowViolations, ViolationWindow);
+	}
+
+	return false;
+}
+
+void ASurvivalPlayerController::NotifyRejectedRpc(const ERateLimitedRpc Rpc)
+{
+	INC_DWORD_STAT(STAT_RpcRejected);
+
+	UE_LOG(LogTemp, Verbose, TEXT("%s sent %s with bad arguments, ignoring it"), *GetName(), *UEnum::GetValueAsString(Rpc));
+}
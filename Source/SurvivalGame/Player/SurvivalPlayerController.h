@@ -6,12 +6,102 @@
 #include "GameFramework/PlayerController.h"
 #include "SurvivalPlayerController.generated.h"
 
+// Server RPCs that cost the server real work and are rate limited per connection.
+UENUM()
+enum class ERateLimitedRpc : uint8
+{
+	RLR_UseItem,
+	RLR_DropItem,
+	RLR_DropItems,
+	RLR_TransferItem,
+	RLR_SortInventory,
+	RLR_BeginInteract,
+	RLR_StashPage,
+	RLR_Craft,
+	RLR_MAX UMETA(Hidden)
+};
+
+USTRUCT()
+struct FRpcRateLimit
+{
+	GENERATED_BODY()
+
+public:
+	FRpcRateLimit()
+		:Rpc(ERateLimitedRpc::RLR_MAX),
+		TokensPerSecond(0.f),
+		BurstSize(0.f)
+	{}
+
+	UPROPERTY(Config)
+	ERateLimitedRpc Rpc;
+
+	UPROPERTY(Config)
+	float TokensPerSecond;
+
+	// Calls that can be made back to back before the rate kicks in. 0 leaves the RPC unlimited.
+	UPROPERTY(Config)
+	float BurstSize;
+};
+
 /**
  * 
  */
-UCLASS()
+UCLASS(Config = Game)
 class SURVIVALGAME_API ASurvivalPlayerController : public APlayerController
 {
 	GENERATED_BODY()
-	
+
+public:
+	ASurvivalPlayerController();
+
+	virtual void PostInitializeComponents() override;
+	virtual void BeginPlay() override;
+	virtual void Tick(float DeltaTime) override;
+
+	// Server only. Takes a token for the RPC, returns false if the call should be dropped.
+	bool ConsumeRpcToken(const ERateLimitedRpc Rpc);
+
+	// Server only. Counts an RPC that was thrown away by a cheap check before doing any work.
+	void NotifyRejectedRpc(const ERateLimitedRpc Rpc);
+
+	// True once dropped calls pass KickViolationThreshold, RPC validation fails from then on and the client is kicked.
+	FORCEINLINE bool IsAbusingRpcs() const { return bAbusingRpcs; }
+
+	FORCEINLINE int32 GetNumDroppedRpcs() const { return NumDroppedRpcs; }
+
+protected:
+
+	UPROPERTY(Config)
+	TArray<FRpcRateLimit> RpcRateLimits;
+
+	// Dropped calls allowed inside ViolationWindow before the client is treated as abusive.
+	UPROPERTY(Config)
+	int32 KickViolationThreshold;
+
+	UPROPERTY(Config)
+	float ViolationWindow;
+
+	// Only on headless load test clients started with -LoadTestBot, plays the game in place of the player.
+	UPROPERTY()
+	class ULoadTestBot* LoadTestBot;
+
+private:
+
+	struct FTokenBucket
+	{
+		float TokensPerSecond = 0.f;
+		float BurstSize = 0.f;
+		float Tokens = 0.f;
+		double LastRefillTime = 0.0;
+	};
+
+	FTokenBucket RpcBuckets[(uint8)ERateLimitedRpc::RLR_MAX];
+
+	int32 NumDroppedRpcs;
+
+	int32 WindowViolations;
+	double ViolationWindowStart;
+
+	bool bAbusingRpcs;
 };
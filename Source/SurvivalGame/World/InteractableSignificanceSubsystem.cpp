@@ -0,0 +1,110 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "World/InteractableSignificanceSubsystem.h"
+#include "Engine/World.h"
+#include "GameFramework/Controller.h"
+#include "SignificanceManager.h"
+
+#include "Components/InteractionComponent.h"
+
+static const FName InteractableSignificanceTag(TEXT("Interactable"));
+
+UInteractableSignificanceSubsystem::UInteractableSignificanceSubsystem()
+	:SignificanceDistance(5000.f),
+	BehindViewScale(0.5f),
+	SignificanceThreshold(0.1f),
+	InsignificantNetUpdateFrequency(1.f)
+{
+}
+
+bool UInteractableSignificanceSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	if (!Super::ShouldCreateSubsystem(Outer))
+		return false;
+
+	const UWorld* World = Cast<UWorld>(Outer);
+	return World && (World->WorldType == EWorldType::Game || World->WorldType == EWorldType::PIE);
+}
+
+void UInteractableSignificanceSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	UWorld* World = GetWorld();
+	USignificanceManager* SignificanceManager = USignificanceManager::Get(World);
+
+	if (!SignificanceManager)
+		return;
+
+	// Clients only have their own controllers, the server has everyone's so an interactable matters if it matters to anyone.
+	// That includes AI controllers, bots interact through the same server side traces players do.
+	Viewpoints.Reset();
+
+	for (FConstControllerIterator It = World->GetControllerIterator(); It; ++It)
+	{
+		AController* Controller = It->Get();
+		if (!Controller || !Controller->GetPawn())
+			continue;
+
+		FVector ViewLocation;
+		FRotator ViewRotation;
+		Controller->GetPlayerViewPoint(ViewLocation, ViewRotation);
+
+		Viewpoints.Add(FTransform(ViewRotation, ViewLocation));
+	}
+
+	SignificanceManager->Update(Viewpoints);
+}
+
+TStatId UInteractableSignificanceSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UInteractableSignificanceSubsystem, STATGROUP_Tickables);
+}
+
+void UInteractableSignificanceSubsystem::RegisterInteractable(UInteractionComponent* Interactable)
+{
+	USignificanceManager* SignificanceManager = USignificanceManager::Get(GetWorld());
+	if (!SignificanceManager || !Interactable)
+		return;
+
+	// Significance is worked out in parallel, so the lambdas only capture copies of the settings.
+	const float Distance = SignificanceDistance;
+	const float BehindScale = BehindViewScale;
+	const float Threshold = SignificanceThreshold;
+
+	auto SignificanceFunction = [Distance, BehindScale](USignificanceManager::FManagedObjectInfo* ObjectInfo, const FTransform& Viewpoint) -> float
+	{
+		const USceneComponent* Component = Cast<USceneComponent>(ObjectInfo->GetObject());
+		if (!Component)
+			return 0.f;
+
+		const FVector ToObject = Component->GetComponentLocation() - Viewpoint.GetLocation();
+		const float DistanceToObject = ToObject.Size();
+
+		if (DistanceToObject >= Distance)
+			return 0.f;
+
+		const float DistanceScore = 1.f - DistanceToObject / Distance;
+		const float ViewDot = DistanceToObject > KINDA_SMALL_NUMBER ? FVector::DotProduct(Viewpoint.GetRotation().GetForwardVector(), ToObject / DistanceToObject) : 1.f;
+
+		return DistanceScore * FMath::Lerp(BehindScale, 1.f, (ViewDot + 1.f) * 0.5f);
+	};
+
+	auto PostSignificanceFunction = [Threshold](USignificanceManager::FManagedObjectInfo* ObjectInfo, float OldSignificance, float Significance, bool bFinal)
+	{
+		UInteractionComponent* Component = Cast<UInteractionComponent>(ObjectInfo->GetObject());
+
+		// Unregistering reports a final significance, which shouldn't turn the component off on its way out.
+		if (Component && !bFinal)
+			Component->SetSignificant(Significance > Threshold);
+	};
+
+	SignificanceManager->RegisterObject(Interactable, InteractableSignificanceTag, SignificanceFunction, USignificanceManager::EPostSignificanceType::Sequential, PostSignificanceFunction);
+}
+
+void UInteractableSignificanceSubsystem::UnregisterInteractable(UInteractionComponent* Interactable)
+{
+	if (USignificanceManager* SignificanceManager = USignificanceManager::Get(GetWorld()))
+		SignificanceManager->UnregisterObject(Interactable);
+}
@@ -0,0 +1,51 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "InteractableSignificanceSubsystem.generated.h"
+
+/**
+ * Scores every interactable with the significance manager by distance and view angle from the players, and tells
+ * them when they cross SignificanceThreshold so the far away ones can stop doing work nobody will see.
+ */
+UCLASS(Config = Game)
+class SURVIVALGAME_API UInteractableSignificanceSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	UInteractableSignificanceSubsystem();
+
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	void RegisterInteractable(class UInteractionComponent* Interactable);
+	void UnregisterInteractable(class UInteractionComponent* Interactable);
+
+	FORCEINLINE float GetInsignificantNetUpdateFrequency() const { return InsignificantNetUpdateFrequency; }
+
+protected:
+
+	// Interactables further than this from every player have no significance.
+	UPROPERTY(Config)
+	float SignificanceDistance;
+
+	// Significance of something directly behind a player relative to something straight ahead of them.
+	UPROPERTY(Config)
+	float BehindViewScale;
+
+	UPROPERTY(Config)
+	float SignificanceThreshold;
+
+	// Server side net update frequency of an interactable's owner while it is insignificant.
+	UPROPERTY(Config)
+	float InsignificantNetUpdateFrequency;
+
+private:
+
+	TArray<FTransform> Viewpoints;
+};
@@ -0,0 +1,123 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "World/InteractionSubsystem.h"
+#include "Engine/World.h"
+
+#include "Player/SurvivalCharacter.h"
+
+UInteractionSubsystem::UInteractionSubsystem()
+	:NextHandle(0)
+{
+}
+
+bool UInteractionSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	if (!Super::ShouldCreateSubsystem(Outer))
+		return false;
+
+	const UWorld* World = Cast<UWorld>(Outer);
+	return World && (World->WorldType == EWorldType::Game || World->WorldType == EWorldType::PIE);
+}
+
+void UInteractionSubsystem::Deinitialize()
+{
+	PendingInteractions.Empty();
+	PendingTraces.Empty();
+	Interactors.Empty();
+
+	Super::Deinitialize();
+}
+
+void UInteractionSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	ApplyInteractionTraces();
+	IssueInteractionTraces();
+
+	const double Now = GetWorld()->GetTimeSeconds();
+
+	while (PendingInteractions.Num() > 0 && PendingInteractions.HeapTop().EndTime <= Now)
+	{
+		FPendingInteraction Interaction;
+		PendingInteractions.HeapPop(Interaction, false);
+
+		if (ASurvivalCharacter* Character = Interaction.Character.Get())
+			Character->OnInteractionTimeReached(Interaction.Handle);
+	}
+}
+
+TStatId UInteractionSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UInteractionSubsystem, STATGROUP_Tickables);
+}
+
+int32 UInteractionSubsystem::StartInteraction(ASurvivalCharacter* Character, const float Duration)
+{
+	// Handles only need to differ from the character's previous one, 0 is kept for no interaction.
+	if (++NextHandle <= 0)
+		NextHandle = 1;
+
+	FPendingInteraction Interaction;
+	Interaction.Character = Character;
+	Interaction.EndTime = GetWorld()->GetTimeSeconds() + Duration;
+	Interaction.Handle = NextHandle;
+
+	PendingInteractions.HeapPush(Interaction);
+
+	return NextHandle;
+}
+
+void UInteractionSubsystem::RegisterInteractor(ASurvivalCharacter* Character)
+{
+	if (Character)
+		Interactors.AddUnique(Character);
+}
+
+void UInteractionSubsystem::ApplyInteractionTraces()
+{
+	UWorld* World = GetWorld();
+
+	FTraceDatum TraceDatum;
+
+	for (const FPendingTrace& Trace : PendingTraces)
+	{
+		ASurvivalCharacter* Character = Trace.Character.Get();
+		if (!Character || !World->QueryTraceData(Trace.Handle, TraceDatum))
+			continue;
+
+		const FHitResult* Hit = TraceDatum.OutHits.Num() > 0 && TraceDatum.OutHits[0].bBlockingHit ? &TraceDatum.OutHits[0] : nullptr;
+		Character->ApplyInteractionTrace(Hit, Trace.Start);
+	}
+
+	PendingTraces.Reset();
+}
+
+void UInteractionSubsystem::IssueInteractionTraces()
+{
+	UWorld* World = GetWorld();
+
+	for (int32 i = Interactors.Num() - 1; i >= 0; --i)
+	{
+		ASurvivalCharacter* Character = Interactors[i].Get();
+		if (!Character)
+		{
+			Interactors.RemoveAtSwap(i, 1, false);
+			continue;
+		}
+
+		FVector TraceStart;
+		FVector TraceEnd;
+		if (!Character->GetInteractionTrace(TraceStart, TraceEnd))
+			continue;
+
+		FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(InteractionTrace));
+		QueryParams.AddIgnoredActor(Character);
+
+		FPendingTrace& Trace = PendingTraces.AddDefaulted_GetRef();
+		Trace.Character = Character;
+		Trace.Start = TraceStart;
+		Trace.Handle = World->AsyncLineTraceByChannel(EAsyncTraceType::Single, TraceStart, TraceEnd, ECC_Visibility, QueryParams);
+	}
+}
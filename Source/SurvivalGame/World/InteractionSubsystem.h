@@ -0,0 +1,67 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "WorldCollision.h"
+#include "InteractionSubsystem.generated.h"
+
+/**
+ * Finishes every timed interaction in the world from one tick instead of a timer per character. Runs wherever
+ * BeginInteract does, the server and the interacting client.
+ *
+ * Also issues every character's interaction trace as one batch of async traces, applying the results a frame later.
+ */
+UCLASS()
+class SURVIVALGAME_API UInteractionSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	UInteractionSubsystem();
+
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Deinitialize() override;
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	// Calls OnInteractionTimeReached on the character once Duration has passed. There is no cancel, the character
+	// ignores handles that aren't its current one.
+	int32 StartInteraction(class ASurvivalCharacter* Character, const float Duration);
+
+	// Characters stay registered until they're destroyed.
+	void RegisterInteractor(class ASurvivalCharacter* Character);
+
+private:
+
+	void ApplyInteractionTraces();
+	void IssueInteractionTraces();
+
+	struct FPendingTrace
+	{
+		TWeakObjectPtr<class ASurvivalCharacter> Character;
+		FTraceHandle Handle;
+		FVector Start;
+	};
+
+	TArray<TWeakObjectPtr<class ASurvivalCharacter>> Interactors;
+
+	// Traces issued last frame, their results are ready this frame.
+	TArray<FPendingTrace> PendingTraces;
+
+	struct FPendingInteraction
+	{
+		TWeakObjectPtr<class ASurvivalCharacter> Character;
+		double EndTime;
+		int32 Handle;
+
+		bool operator<(const FPendingInteraction& Other) const { return EndTime < Other.EndTime; }
+	};
+
+	// Min-heap on EndTime, so a tick with nothing due only looks at the top.
+	TArray<FPendingInteraction> PendingInteractions;
+
+	int32 NextHandle;
+};
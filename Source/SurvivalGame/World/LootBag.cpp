@@ -0,0 +1,52 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "World/LootBag.h"
+#include "GameFramework/PlayerController.h"
+
+#include "Player/SurvivalCharacter.h"
+#include "Components/InteractionComponent.h"
+#include "Components/InventoryComponent.h"
+
+ALootBag::ALootBag()
+{
+	InteractionComponent->InteractableNameText = FText::FromString(TEXT("Bag"));
+	InteractionComponent->InteractableActionText = FText::FromString(TEXT("Open"));
+	InteractionComponent->OnEndFocus.AddDynamic(this, &ALootBag::OnBagUnfocused);
+
+	BagInventory = CreateDefaultSubobject<UInventoryComponent>(TEXT("Bag Inventory"));
+	BagInventory->SetReplicationPolicy(EInventoryReplicationPolicy::IRP_ViewersOnly);
+	BagInventory->SetCapacity(50);
+	BagInventory->SetWeightCapacity(1000.f);
+}
+
+void ALootBag::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (HasAuthority())
+		BagInventory->OnItemRemoved.AddUObject(this, &ALootBag::OnBagItemRemoved);
+}
+
+void ALootBag::OnTakePickup(ASurvivalCharacter* Taker)
+{
+	if (!Taker || IsPendingKillPending())
+		return;
+
+	if (HasAuthority())
+		BagInventory->AddViewer(Cast<APlayerController>(Taker->GetController()));
+
+	OnBagOpened(Taker);
+}
+
+void ALootBag::OnBagUnfocused(ASurvivalCharacter* Character)
+{
+	if (HasAuthority() && Character)
+		BagInventory->RemoveViewer(Cast<APlayerController>(Character->GetController()));
+}
+
+void ALootBag::OnBagItemRemoved(UItem* RemovedItem)
+{
+	if (BagInventory->GetNumItems() == 0)
+		Destroy();
+}
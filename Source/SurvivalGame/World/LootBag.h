@@ -0,0 +1,39 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "World/Pickup.h"
+#include "LootBag.generated.h"
+
+/**
+ * A pickup holding many items, so a bulk drop costs one actor instead of one per item. Its contents only
+ * replicate to players that have it open.
+ */
+UCLASS()
+class SURVIVALGAME_API ALootBag : public APickup
+{
+	GENERATED_BODY()
+
+public:
+	ALootBag();
+
+	FORCEINLINE class UInventoryComponent* GetBagInventory() const { return BagInventory; }
+
+	// Called on the server and the opening client, the client side should show the bag UI.
+	UFUNCTION(BlueprintImplementableEvent)
+	void OnBagOpened(class ASurvivalCharacter* Opener);
+
+protected:
+	virtual void BeginPlay() override;
+
+	virtual void OnTakePickup(class ASurvivalCharacter* Taker) override;
+
+	UFUNCTION()
+	void OnBagUnfocused(class ASurvivalCharacter* Character);
+
+	void OnBagItemRemoved(class UItem* RemovedItem);
+
+	UPROPERTY(EditAnywhere, Category = "Components")
+	class UInventoryComponent* BagInventory;
+};
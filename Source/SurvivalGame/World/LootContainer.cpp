@@ -0,0 +1,135 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "World/LootContainer.h"
+#include "TimerManager.h"
+
+#include "Player/SurvivalCharacter.h"
+#include "Components/InteractionComponent.h"
+#include "Components/InventoryComponent.h"
+#include "Items/LootTable.h"
+
+ALootContainer::ALootContainer()
+	:LootTable(nullptr),
+	LootSeed(0),
+	DematerializeDelay(60.f),
+	bMaterialized(false),
+	bOpened(false)
+{
+	SetReplicates(true);
+
+	ContainerMesh = CreateDefaultSubobject<UStaticMeshComponent>(TEXT("ContainerMesh"));
+	SetRootComponent(ContainerMesh);
+
+	InteractionComponent = CreateDefaultSubobject<UInteractionComponent>(TEXT("Interaction Component"));
+	InteractionComponent->InteractionTime = 0.5f;
+	InteractionComponent->InteractionDistance = 250.f;
+	InteractionComponent->InteractableNameText = FText::FromString(TEXT("Container"));
+	InteractionComponent->InteractableActionText = FText::FromString(TEXT("Open"));
+	InteractionComponent->OnBeginFocus.AddDynamic(this, &ALootContainer::OnContainerFocused);
+	InteractionComponent->OnEndFocus.AddDynamic(this, &ALootContainer::OnContainerUnfocused);
+	InteractionComponent->OnInteract.AddDynamic(this, &ALootContainer::OnOpenContainer);
+	InteractionComponent->SetupAttachment(RootComponent);
+
+	Inventory = CreateDefaultSubobject<UInventoryComponent>(TEXT("Inventory"));
+	Inventory->SetCapacity(30);
+	Inventory->SetWeightCapacity(500.f);
+}
+
+void ALootContainer::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (HasAuthority() && LootSeed == 0)
+		LootSeed = FMath::Rand();
+}
+
+void ALootContainer::OnContainerFocused(ASurvivalCharacter* Character)
+{
+	// The server sees focus changes for every player, so this is the first sign someone is about to open us.
+	if (!HasAuthority() || !Character)
+		return;
+
+	if (!FocusingCharacters.Contains(Character))
+	{
+		FocusingCharacters.Add(Character);
+		Character->OnDestroyed.AddUniqueDynamic(this, &ALootContainer::OnFocusingCharacterDestroyed);
+	}
+
+	Materialize();
+	GetWorldTimerManager().ClearTimer(TimerHandle_Dematerialize);
+}
+
+void ALootContainer::OnContainerUnfocused(ASurvivalCharacter* Character)
+{
+	if (!HasAuthority())
+		return;
+
+	if (Character)
+		Character->OnDestroyed.RemoveDynamic(this, &ALootContainer::OnFocusingCharacterDestroyed);
+
+	RemoveFocusingCharacter(Character);
+}
+
+void ALootContainer::OnFocusingCharacterDestroyed(AActor* DestroyedActor)
+{
+	RemoveFocusingCharacter(DestroyedActor);
+}
+
+void ALootContainer::RemoveFocusingCharacter(const AActor* Character)
+{
+	// A character without a controller has left or died, it won't be opening us.
+	FocusingCharacters.RemoveAll([Character](const TWeakObjectPtr<ASurvivalCharacter>& FocusingCharacter)
+	{
+		return !FocusingCharacter.IsValid() || FocusingCharacter.Get() == Character || !FocusingCharacter->GetController();
+	});
+
+	if (FocusingCharacters.Num() > 0 || !bMaterialized || bOpened || DematerializeDelay <= 0.f)
+		return;
+
+	GetWorldTimerManager().SetTimer(TimerHandle_Dematerialize, this, &ALootContainer::Dematerialize, DematerializeDelay, false);
+}
+
+void ALootContainer::OnOpenContainer(ASurvivalCharacter* Opener)
+{
+	if (HasAuthority())
+	{
+		Materialize();
+
+		bOpened = true;
+		GetWorldTimerManager().ClearTimer(TimerHandle_Dematerialize);
+	}
+
+	OnContainerOpened(Opener);
+}
+
+void ALootContainer::Materialize()
+{
+	if (bMaterialized || !LootTable)
+		return;
+
+	bMaterialized = true;
+
+	// A single container is cheap to roll in place, only bulk rolls go through the loot subsystem.
+	TArray<FLootDrop> Drops = LootTable->RollLoot(LootSeed);
+	ULootTable::SplitIntoStacks(Drops);
+
+	for (const FLootDrop& Drop : Drops)
+	{
+		if (Inventory->TryAddItemOfClass(Drop.ItemClass, Drop.Quantity).Result != EItemAddResult::IAR_AllItemsAdded)
+			break;
+	}
+}
+
+void ALootContainer::Dematerialize()
+{
+	if (!bMaterialized || bOpened)
+		return;
+
+	bMaterialized = false;
+
+	for (UItem* Item : Inventory->GetItems())
+	{
+		Inventory->RemoveItem(Item);
+	}
+}
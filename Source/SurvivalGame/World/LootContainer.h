@@ -0,0 +1,85 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "LootContainer.generated.h"
+
+/**
+ * World container whose contents only exist once someone looks at or opens it. Until then it is just a
+ * loot table and a seed, and an unopened container drops back to that after a while.
+ */
+UCLASS()
+class SURVIVALGAME_API ALootContainer : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	ALootContainer();
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Loot")
+	class ULootTable* LootTable;
+
+	// 0 picks a random seed when play begins.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Loot")
+	int32 LootSeed;
+
+	// Seconds a materialized container can sit unopened before its contents are thrown away again.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Loot")
+	float DematerializeDelay;
+
+	UFUNCTION(BlueprintPure, Category = "Loot")
+	FORCEINLINE bool IsMaterialized() const { return bMaterialized; }
+
+	UFUNCTION(BlueprintPure, Category = "Loot")
+	FORCEINLINE bool HasBeenOpened() const { return bOpened; }
+
+	FORCEINLINE class UInventoryComponent* GetInventory() const { return Inventory; }
+
+	// Called on the server and the opening client, the client side should show the container UI.
+	UFUNCTION(BlueprintImplementableEvent)
+	void OnContainerOpened(class ASurvivalCharacter* Opener);
+
+protected:
+	virtual void BeginPlay() override;
+
+	UFUNCTION()
+	void OnContainerFocused(class ASurvivalCharacter* Character);
+
+	UFUNCTION()
+	void OnContainerUnfocused(class ASurvivalCharacter* Character);
+
+	UFUNCTION()
+	void OnOpenContainer(class ASurvivalCharacter* Opener);
+
+	// Disconnecting or being destroyed while looking at us never ends focus.
+	UFUNCTION()
+	void OnFocusingCharacterDestroyed(AActor* DestroyedActor);
+
+	// Drops Character and any focusing character that is gone, then starts the dematerialize timer if no one is left.
+	void RemoveFocusingCharacter(const AActor* Character);
+
+	void Materialize();
+	void Dematerialize();
+
+	UPROPERTY(EditAnywhere, Category = "Components")
+	class UStaticMeshComponent* ContainerMesh;
+
+	UPROPERTY(EditAnywhere, Category = "Components")
+	class UInteractionComponent* InteractionComponent;
+
+	UPROPERTY(EditAnywhere, Category = "Components")
+	class UInventoryComponent* Inventory;
+
+private:
+
+	bool bMaterialized;
+
+	// Once a player has been inside, the contents are theirs to change and can't be re-rolled from the seed.
+	bool bOpened;
+
+	TArray<TWeakObjectPtr<class ASurvivalCharacter>> FocusingCharacters;
+
+	FTimerHandle TimerHandle_Dematerialize;
+};
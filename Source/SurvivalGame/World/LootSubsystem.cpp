@@ -0,0 +1,167 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "World/LootSubsystem.h"
+#include "Async/ParallelFor.h"
+#include "Engine/World.h"
+
+#include "Components/InventoryComponent.h"
+#include "Items/Item.h"
+#include "World/Pickup.h"
+
+namespace LootSubsystem
+{
+	// Spreads pickups rolled for the same spawn point around it instead of stacking them on one spot.
+	static constexpr float PickupSpread = 30.f;
+}
+
+ULootSubsystem::ULootSubsystem()
+	:ApplyBudgetMs(1.f),
+	ApplyRequest(0),
+	ApplyDropIndex(0)
+{
+}
+
+void ULootSubsystem::Deinitialize()
+{
+	RollTask.Wait();
+
+	PendingRequests.Empty();
+	RollingRequests.Empty();
+	ApplyingRequests.Empty();
+
+	Super::Deinitialize();
+}
+
+void ULootSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	if (RollingRequests.Num() > 0 && RollTask.IsCompleted())
+	{
+		ApplyingRequests.Append(MoveTemp(RollingRequests));
+		RollingRequests.Reset();
+	}
+
+	if (RollingRequests.Num() == 0 && PendingRequests.Num() > 0)
+		StartRolling();
+
+	if (ApplyingRequests.Num() > 0)
+		ApplyRolledLoot();
+}
+
+TStatId ULootSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(ULootSubsystem, STATGROUP_Tickables);
+}
+
+void ULootSubsystem::RequestInventoryLoot(ULootTable* Table, const int32 Seed, UInventoryComponent* Inventory)
+{
+	if (!Table || !Inventory || GetWorld()->GetNetMode() == NM_Client)
+		return;
+
+	FLootRequest& Request = PendingRequests.AddDefaulted_GetRef();
+	Request.Table = Table;
+	Request.Seed = Seed;
+	Request.Inventory = Inventory;
+}
+
+void ULootSubsystem::RequestPickupLoot(ULootTable* Table, const int32 Seed, const FTransform& SpawnTransform)
+{
+	if (!Table || GetWorld()->GetNetMode() == NM_Client)
+		return;
+
+	FLootRequest& Request = PendingRequests.AddDefaulted_GetRef();
+	Request.Table = Table;
+	Request.Seed = Seed;
+	Request.SpawnTransform = SpawnTransform;
+}
+
+void ULootSubsystem::StartRolling()
+{
+	// Tables are only read from here on, so compile them while we are still on the game thread.
+	for (FLootRequest& Request : PendingRequests)
+	{
+		Request.Table->Compile();
+	}
+
+	RollingRequests = MoveTemp(PendingRequests);
+	PendingRequests.Reset();
+
+	RollTask = UE::Tasks::Launch(UE_SOURCE_LOCATION, [this]()
+	{
+		ParallelFor(RollingRequests.Num(), [this](const int32 Index)
+		{
+			FLootRequest& Request = RollingRequests[Index];
+			FRandomStream Stream(Request.Seed);
+
+			Request.Table->Roll(Stream, Request.Drops);
+			ULootTable::SplitIntoStacks(Request.Drops);
+		});
+	});
+}
+
+void ULootSubsystem::ApplyRolledLoot()
+{
+	const double EndTime = FPlatformTime::Seconds() + ApplyBudgetMs / 1000.0;
+
+	while (ApplyRequest < ApplyingRequests.Num())
+	{
+		const FLootRequest& Request = ApplyingRequests[ApplyRequest];
+
+		for (; ApplyDropIndex < Request.Drops.Num(); ++ApplyDropIndex)
+		{
+			if (FPlatformTime::Seconds() > EndTime)
+				return;
+
+			// Stop once an inventory is full, the rest would fail the same way.
+			if (!ApplyDrop(Request, Request.Drops[ApplyDropIndex]))
+				break;
+		}
+
+		++ApplyRequest;
+		ApplyDropIndex = 0;
+	}
+
+	ApplyingRequests.Reset();
+	ApplyRequest = 0;
+}
+
+bool ULootSubsystem::ApplyDrop(const FLootRequest& Request, const FLootDrop& Drop)
+{
+	if (Request.Inventory.IsStale())
+		return false;
+
+	if (UInventoryComponent* Inventory = Request.Inventory.Get())
+	{
+		const FItemAddResult AddResult = Inventory->TryAddItemOfClass(Drop.ItemClass, Drop.Quantity);
+		return AddResult.Result == EItemAddResult::IAR_AllItemsAdded;
+	}
+
+	UClass* PickupClass = Drop.ItemClass->GetDefaultObject<UItem>()->PickupClass;
+
+	if (!PickupClass)
+		PickupClass = DefaultPickupClass.LoadSynchronous();
+
+	if (!PickupClass)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Couldn't spawn a pickup for %s, it has no PickupClass and DefaultPickupClass %s didn't load."), *Drop.ItemClass->GetName(), *DefaultPickupClass.ToString());
+		return true;
+	}
+
+	FTransform SpawnTransform = Request.SpawnTransform;
+
+	if (ApplyDropIndex > 0)
+	{
+		const float Angle = ApplyDropIndex * (2.f * PI / 7.f);
+		SpawnTransform.AddToTranslation(FVector(FMath::Cos(Angle), FMath::Sin(Angle), 0.f) * LootSubsystem::PickupSpread);
+	}
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+
+	if (APickup* Pickup = GetWorld()->SpawnActor<APickup>(PickupClass, SpawnTransform, SpawnParams))
+		Pickup->InitPickup(Drop.ItemClass, Drop.Quantity);
+
+	return true;
+}
@@ -0,0 +1,92 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tasks/Task.h"
+#include "Items/LootTable.h"
+#include "LootSubsystem.generated.h"
+
+USTRUCT()
+struct FLootRequest
+{
+	GENERATED_BODY()
+
+public:
+	FLootRequest()
+		:Table(nullptr),
+		Seed(0)
+	{}
+
+	UPROPERTY()
+	class ULootTable* Table;
+
+	int32 Seed;
+
+	// Either added to this inventory, or spawned as pickups at SpawnTransform.
+	TWeakObjectPtr<class UInventoryComponent> Inventory;
+	FTransform SpawnTransform;
+
+	// Filled in on a worker thread, so deliberately not a UPROPERTY the GC could be walking at the same time.
+	TArray<FLootDrop> Drops;
+};
+
+/**
+ * Rolls loot tables in batches off the game thread. Only adding the results to inventories and spawning
+ * pickups happens on the game thread, spread over frames within a time budget.
+ */
+UCLASS(Config = Game)
+class SURVIVALGAME_API ULootSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	ULootSubsystem();
+
+	virtual void Deinitialize() override;
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	UFUNCTION(BlueprintCallable, Category = "Loot")
+	void RequestInventoryLoot(class ULootTable* Table, const int32 Seed, class UInventoryComponent* Inventory);
+
+	UFUNCTION(BlueprintCallable, Category = "Loot")
+	void RequestPickupLoot(class ULootTable* Table, const int32 Seed, const FTransform& SpawnTransform);
+
+	UFUNCTION(BlueprintPure, Category = "Loot")
+	FORCEINLINE int32 GetNumPendingRequests() const { return PendingRequests.Num() + RollingRequests.Num() + ApplyingRequests.Num(); }
+
+protected:
+
+	// Game thread time spent adding rolled loot to the world each frame.
+	UPROPERTY(Config)
+	float ApplyBudgetMs;
+
+	// Spawned for rolled items that don't specify a PickupClass.
+	UPROPERTY(Config)
+	TSoftClassPtr<class APickup> DefaultPickupClass;
+
+private:
+
+	void StartRolling();
+	void ApplyRolledLoot();
+
+	bool ApplyDrop(const FLootRequest& Request, const FLootDrop& Drop);
+
+	UPROPERTY()
+	TArray<FLootRequest> PendingRequests;
+
+	// Owned by the worker task until it completes, the game thread must not touch it.
+	UPROPERTY()
+	TArray<FLootRequest> RollingRequests;
+
+	UPROPERTY()
+	TArray<FLootRequest> ApplyingRequests;
+
+	UE::Tasks::FTask RollTask;
+
+	int32 ApplyRequest;
+	int32 ApplyDropIndex;
+};
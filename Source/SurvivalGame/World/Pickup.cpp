@@ -9,8 +9,11 @@
 #include "Items/Item.h"
 #include "Components/InteractionComponent.h"
 #include "Components/InventoryComponent.h"
+#include "World/PickupSubsystem.h"
+#include "Items/ItemPoolSubsystem.h"
 
 APickup::APickup()
+	:SignificantVisibilityResponse(ECR_Block)
 {
 	PrimaryActorTick.bCanEverTick = true;
 	
@@ -34,7 +37,7 @@ void APickup::InitPickup(const TSubclassOf<class UItem> ItemClass, const int32 Q
 {
 	if (HasAuthority() && ItemClass && Quantity > 0)
 	{
-		Item = NewObject<UItem>(this, ItemClass);
+		Item = UItemPoolSubsystem::AcquireItem(this, ItemClass);
 		Item->SetQuantity(Quantity);
 
 		OnRep_Item();
@@ -56,7 +59,28 @@ void APickup::BeginPlay()
 	if (Item)
 		Item->MarkDirtyForReplication();
 
-	
+	SignificantVisibilityResponse = PickupMesh->GetCollisionResponseToChannel(ECC_Visibility);
+	InteractionComponent->OnSignificanceChanged.AddUObject(this, &APickup::OnSignificanceChanged);
+
+	if (HasAuthority())
+	{
+		if (UPickupSubsystem* PickupSubsystem = GetWorld()->GetSubsystem<UPickupSubsystem>())
+			PickupSubsystem->RegisterPickup(this);
+	}
+}
+
+void APickup::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UPickupSubsystem* PickupSubsystem = GetWorld()->GetSubsystem<UPickupSubsystem>())
+		PickupSubsystem->UnregisterPickup(this);
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void APickup::SetPredictedTaken(const bool bTaken)
+{
+	SetActorHiddenInGame(bTaken);
+	SetActorEnableCollision(!bTaken);
 }
 
 void APickup::OnRep_Item()
@@ -80,6 +104,12 @@ void APickup::OnItemModified()
 
 }
 
+void APickup::OnSignificanceChanged(bool bSignificant)
+{
+	// Far enough away that no interaction trace could reach us, so there's no point being in the way of one.
+	PickupMesh->SetCollisionResponseToChannel(ECC_Visibility, bSignificant ? SignificantVisibilityResponse.GetValue() : ECR_Ignore);
+}
+
 void APickup::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
 {
 	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
@@ -115,6 +145,15 @@ void APickup::OnTakePickup(ASurvivalCharacter* Taker)
 	if (!Taker  || IsPendingKillPending() || !Item)
 		return;
 
+	// Only the server can add the item, the local player just sees it taken straight away.
+	if (!HasAuthority())
+	{
+		if (Taker->IsLocallyControlled())
+			Taker->PredictPickup(this);
+
+		return;
+	}
+
 	const FItemAddResult AddResult = Taker->PlayerInventory->TryAddItem(Item);
 
 	UE_LOG(LogTemp, Warning, TEXT("AddResult: %i"),AddResult.ActualAmountGiven);
@@ -122,6 +161,9 @@ void APickup::OnTakePickup(ASurvivalCharacter* Taker)
 	if (AddResult.ActualAmountGiven < Item->GetQuantity())
 	{
 		Item->SetQuantity(Item->GetQuantity() - AddResult.ActualAmountGiven);
+
+		// Some or all of it didn't fit, so the taker's prediction was wrong.
+		Taker->ClientRejectPickup(this);
 	}
 	else if (AddResult.ActualAmountGiven >= Item->GetQuantity())
 	{
@@ -23,8 +23,14 @@ public:
 	UFUNCTION(BlueprintImplementableEvent)
 	void AlignWithGround();
 
+	FORCEINLINE class UItem* GetItem() const { return Item; }
+
+	// Client side, hides the pickup while the local player's take is waiting on the server.
+	void SetPredictedTaken(const bool bTaken);
+
 protected:
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
 	UPROPERTY(BlueprintReadWrite, VisibleAnywhere, ReplicatedUsing = OnRep_Item)
 	class UItem* Item;
@@ -35,6 +41,8 @@ protected:
 	UFUNCTION()
 	void OnItemModified();
 
+	void OnSignificanceChanged(bool bSignificant);
+
 	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
 	virtual bool ReplicateSubobjects(class UActorChannel* Channel, class FOutBunch* Bunch, FReplicationFlags* RepFlags) override;
 
@@ -43,11 +51,16 @@ protected:
 #endif
 
 	UFUNCTION()
-	void OnTakePickup(class ASurvivalCharacter* Taker);
+	virtual void OnTakePickup(class ASurvivalCharacter* Taker);
 
 	UPROPERTY(EditAnywhere, Category = "Components")
 	class UStaticMeshComponent* PickupMesh;
 
 	UPROPERTY(EditAnywhere, Category = "Components")
 	class UInteractionComponent* InteractionComponent;
+
+private:
+
+	// What the mesh blocks interaction traces with while we're significant.
+	TEnumAsByte<ECollisionResponse> SignificantVisibilityResponse;
 };
@@ -0,0 +1,249 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "World/PickupDespawnSubsystem.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/Pawn.h"
+
+#include "World/Pickup.h"
+#include "World/PickupSubsystem.h"
+#include "World/LootBag.h"
+#include "Items/Item.h"
+#include "Components/InventoryComponent.h"
+
+DECLARE_STATS_GROUP(TEXT("PickupDespawn"), STATGROUP_PickupDespawn, STATCAT_Advanced);
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Pickups"), STAT_DespawnNumPickups, STATGROUP_PickupDespawn);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Eviction Candidates"), STAT_DespawnNumCandidates, STATGROUP_PickupDespawn);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Expired"), STAT_DespawnNumExpired, STATGROUP_PickupDespawn);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Soft Cap Evictions"), STAT_DespawnNumSoftEvicted, STATGROUP_PickupDespawn);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Hard Cap Evictions"), STAT_DespawnNumHardEvicted, STATGROUP_PickupDespawn);
+
+UPickupDespawnSubsystem::UPickupDespawnSubsystem()
+	:SoftCap(2000),
+	HardCap(4000),
+	BudgetMs(0.5f),
+	PlayerProtectRadius(1500.f),
+	SweepCursor(0),
+	SweepDropped(0),
+	SweepPlaced(0)
+{
+	DroppedPolicy.Lifetime = 3600.f;
+	DroppedPolicy.MinAgeBeforeEviction = 60.f;
+	DroppedPolicy.bEvictable = true;
+}
+
+bool UPickupDespawnSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	if (!Super::ShouldCreateSubsystem(Outer))
+		return false;
+
+	const UWorld* World = Cast<UWorld>(Outer);
+	return World && (World->WorldType == EWorldType::Game || World->WorldType == EWorldType::PIE);
+}
+
+void UPickupDespawnSubsystem::Deinitialize()
+{
+	PendingCandidates.Empty();
+	Candidates.Empty();
+
+	Super::Deinitialize();
+}
+
+void UPickupDespawnSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	UWorld* World = GetWorld();
+	UPickupSubsystem* PickupSubsystem = World->GetSubsystem<UPickupSubsystem>();
+
+	if (World->GetNetMode() == NM_Client || !PickupSubsystem)
+		return;
+
+	const TArray<APickup*>& Pickups = PickupSubsystem->GetPickups();
+	const double EndTime = FPlatformTime::Seconds() + BudgetMs / 1000.0;
+
+	PlayerLocations.Reset();
+
+	for (FConstPlayerControllerIterator It = World->GetPlayerControllerIterator(); It; ++It)
+	{
+		if (APawn* Pawn = It->Get() ? It->Get()->GetPawn() : nullptr)
+			PlayerLocations.Add(Pawn->GetActorLocation());
+	}
+
+	// Over the hard cap nothing waits for the budget, not even the sweep that finds candidates. Right after startup
+	// or a burst of spawns the candidates are missing or stale, so they are rebuilt once on the spot.
+	bool bSweptForHardCap = false;
+
+	while (Pickups.Num() > HardCap)
+	{
+		if (!EvictLowestValue())
+		{
+			if (bSweptForHardCap)
+				break;
+
+			SweepAll(Pickups);
+			bSweptForHardCap = true;
+			continue;
+		}
+
+		++Stats.NumHardEvicted;
+		INC_DWORD_STAT(STAT_DespawnNumHardEvicted);
+	}
+
+	while (FPlatformTime::Seconds() < EndTime)
+	{
+		if (SweepCursor >= Pickups.Num())
+		{
+			FinishSweep();
+			break;
+		}
+
+		// Destroying a pickup swaps the last one into its slot, which then needs scoring too.
+		if (ScorePickup(Pickups[SweepCursor]))
+			++SweepCursor;
+	}
+
+	while (Pickups.Num() > SoftCap && FPlatformTime::Seconds() < EndTime && EvictLowestValue())
+	{
+		++Stats.NumSoftEvicted;
+		INC_DWORD_STAT(STAT_DespawnNumSoftEvicted);
+	}
+
+	Stats.NumPickups = Pickups.Num();
+	SET_DWORD_STAT(STAT_DespawnNumPickups, Stats.NumPickups);
+}
+
+TStatId UPickupDespawnSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UPickupDespawnSubsystem, STATGROUP_Tickables);
+}
+
+bool UPickupDespawnSubsystem::ScorePickup(APickup* Pickup)
+{
+	const FPickupDespawnPolicy& Policy = Pickup->bNetStartup ? PlacedPolicy : DroppedPolicy;
+	const float Age = Pickup->GetGameTimeSinceCreation();
+
+	if (Policy.Lifetime > 0.f && Age >= Policy.Lifetime)
+	{
+		Pickup->Destroy();
+
+		++Stats.NumExpired;
+		INC_DWORD_STAT(STAT_DespawnNumExpired);
+		return false;
+	}
+
+	if (Pickup->bNetStartup)
+		++SweepPlaced;
+	else
+		++SweepDropped;
+
+	if (!Policy.bEvictable || Age < Policy.MinAgeBeforeEviction)
+		return true;
+
+	const float PlayerDistance = GetNearestPlayerDistance(Pickup->GetActorLocation());
+
+	if (PlayerDistance >= 0.f && PlayerDistance < PlayerProtectRadius)
+		return true;
+
+	FDespawnCandidate Candidate;
+	Candidate.Value = Policy.RarityValue * GetPickupRarity(Pickup) - Policy.AgePenalty * Age / 60.f - Policy.DistancePenalty * FMath::Max(PlayerDistance, 0.f) / 1000.f;
+	Candidate.Pickup = Pickup;
+
+	PendingCandidates.Add(Candidate);
+	return true;
+}
+
+void UPickupDespawnSubsystem::FinishSweep()
+{
+	Candidates = MoveTemp(PendingCandidates);
+	Candidates.Heapify();
+
+	Stats.NumDropped = SweepDropped;
+	Stats.NumPlaced = SweepPlaced;
+	Stats.NumCandidates = Candidates.Num();
+	++Stats.NumSweeps;
+	SET_DWORD_STAT(STAT_DespawnNumCandidates, Stats.NumCandidates);
+
+	PendingCandidates.Reset();
+	SweepCursor = 0;
+	SweepDropped = 0;
+	SweepPlaced = 0;
+}
+
+void UPickupDespawnSubsystem::SweepAll(const TArray<APickup*>& Pickups)
+{
+	PendingCandidates.Reset();
+	SweepCursor = 0;
+	SweepDropped = 0;
+	SweepPlaced = 0;
+
+	while (SweepCursor < Pickups.Num())
+	{
+		if (ScorePickup(Pickups[SweepCursor]))
+			++SweepCursor;
+	}
+
+	FinishSweep();
+}
+
+bool UPickupDespawnSubsystem::EvictLowestValue()
+{
+	while (Candidates.Num() > 0)
+	{
+		FDespawnCandidate Candidate;
+		Candidates.HeapPop(Candidate, false);
+
+		APickup* Pickup = Candidate.Pickup.Get();
+
+		if (!Pickup || Pickup->IsPendingKillPending())
+			continue;
+
+		// Scores can be a sweep old, don't pull something out from under a player who has since walked up to it.
+		const float PlayerDistance = GetNearestPlayerDistance(Pickup->GetActorLocation());
+
+		if (PlayerDistance >= 0.f && PlayerDistance < PlayerProtectRadius)
+			continue;
+
+		Pickup->Destroy();
+		return true;
+	}
+
+	return false;
+}
+
+float UPickupDespawnSubsystem::GetNearestPlayerDistance(const FVector& Location) const
+{
+	if (PlayerLocations.Num() == 0)
+		return -1.f;
+
+	float MinDistSquared = MAX_flt;
+
+	for (const FVector& PlayerLocation : PlayerLocations)
+	{
+		MinDistSquared = FMath::Min(MinDistSquared, (float)FVector::DistSquared(Location, PlayerLocation));
+	}
+
+	return FMath::Sqrt(MinDistSquared);
+}
+
+float UPickupDespawnSubsystem::GetPickupRarity(const APickup* Pickup)
+{
+	if (const UItem* Item = Pickup->GetItem())
+		return (float)Item->Rarity;
+
+	// A bag is worth as much as the best thing in it.
+	uint8 MaxRarity = 0;
+
+	if (const ALootBag* Bag = Cast<ALootBag>(Pickup))
+	{
+		for (const UItem* BagItem : Bag->GetBagInventory()->GetItems())
+		{
+			if (BagItem)
+				MaxRarity = FMath::Max(MaxRarity, (uint8)BagItem->Rarity);
+		}
+	}
+
+	return (float)MaxRarity;
+}
@@ -0,0 +1,175 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "PickupDespawnSubsystem.generated.h"
+
+USTRUCT()
+struct FPickupDespawnPolicy
+{
+	GENERATED_BODY()
+
+public:
+	FPickupDespawnPolicy()
+		:Lifetime(0.f),
+		MinAgeBeforeEviction(0.f),
+		bEvictable(false),
+		RarityValue(10.f),
+		AgePenalty(1.f),
+		DistancePenalty(1.f)
+	{}
+
+	// Seconds until a pickup is removed no matter what, 0 to never expire.
+	UPROPERTY(Config)
+	float Lifetime;
+
+	// Pickups younger than this are never evicted to get back under the caps.
+	UPROPERTY(Config)
+	float MinAgeBeforeEviction;
+
+	UPROPERTY(Config)
+	bool bEvictable;
+
+	// Value = RarityValue * rarity - AgePenalty * minutes alive - DistancePenalty * tens of meters to the nearest player.
+	// The lowest value pickups are evicted first.
+	UPROPERTY(Config)
+	float RarityValue;
+
+	UPROPERTY(Config)
+	float AgePenalty;
+
+	UPROPERTY(Config)
+	float DistancePenalty;
+};
+
+USTRUCT(BlueprintType)
+struct FPickupDespawnStats
+{
+	GENERATED_BODY()
+
+public:
+	FPickupDespawnStats()
+		:NumPickups(0),
+		NumDropped(0),
+		NumPlaced(0),
+		NumCandidates(0),
+		NumSweeps(0),
+		NumExpired(0),
+		NumSoftEvicted(0),
+		NumHardEvicted(0)
+	{}
+
+	UPROPERTY(BlueprintReadOnly, Category = "Pickups")
+	int32 NumPickups;
+
+	// Dropped/placed split and candidates are as of the last finished sweep.
+	UPROPERTY(BlueprintReadOnly, Category = "Pickups")
+	int32 NumDropped;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Pickups")
+	int32 NumPlaced;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Pickups")
+	int32 NumCandidates;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Pickups")
+	int32 NumSweeps;
+
+	// Totals since the world started.
+	UPROPERTY(BlueprintReadOnly, Category = "Pickups")
+	int32 NumExpired;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Pickups")
+	int32 NumSoftEvicted;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Pickups")
+	int32 NumHardEvicted;
+};
+
+/**
+ * Keeps the number of pickups in the world bounded. Sweeps the pickup registry a slice at a time, expiring old
+ * pickups and scoring the rest, and evicts the lowest value ones while the world is over its caps.
+ */
+UCLASS(Config = Game)
+class SURVIVALGAME_API UPickupDespawnSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	UPickupDespawnSubsystem();
+
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Deinitialize() override;
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	UFUNCTION(BlueprintPure, Category = "Pickups")
+	FORCEINLINE FPickupDespawnStats GetDespawnStats() const { return Stats; }
+
+protected:
+
+	// Pickups spawned at runtime, by players dropping items, loot or snapshot restores.
+	UPROPERTY(Config)
+	FPickupDespawnPolicy DroppedPolicy;
+
+	// Pickups placed in the level (bNetStartup). These only come back when the map reloads.
+	UPROPERTY(Config)
+	FPickupDespawnPolicy PlacedPolicy;
+
+	// Above this, pickups are evicted within the frame budget.
+	UPROPERTY(Config)
+	int32 SoftCap;
+
+	// Above this, pickups are evicted straight away regardless of the budget.
+	UPROPERTY(Config)
+	int32 HardCap;
+
+	UPROPERTY(Config)
+	float BudgetMs;
+
+	// Pickups this close to a player are never evicted, only expired.
+	UPROPERTY(Config)
+	float PlayerProtectRadius;
+
+private:
+
+	struct FDespawnCandidate
+	{
+		float Value;
+		TWeakObjectPtr<class APickup> Pickup;
+
+		bool operator<(const FDespawnCandidate& Other) const { return Value < Other.Value; }
+	};
+
+	// Expires the pickup or adds it to the next set of candidates, returns false if it was destroyed.
+	bool ScorePickup(class APickup* Pickup);
+
+	void FinishSweep();
+
+	// Restarts the sweep and scores every pickup now, for when the hard cap can't wait for the budgeted one.
+	void SweepAll(const TArray<class APickup*>& Pickups);
+
+	bool EvictLowestValue();
+
+	// Distance to the nearest player, or -1 if nobody is playing.
+	float GetNearestPlayerDistance(const FVector& Location) const;
+
+	static float GetPickupRarity(const class APickup* Pickup);
+
+	TArray<FVector> PlayerLocations;
+
+	int32 SweepCursor;
+	int32 SweepDropped;
+	int32 SweepPlaced;
+
+	// Scored by the sweep in progress, swapped into Candidates when it finishes.
+	TArray<FDespawnCandidate> PendingCandidates;
+
+	// Min heap on value, from the last finished sweep.
+	TArray<FDespawnCandidate> Candidates;
+
+	FPickupDespawnStats Stats;
+};
@@ -0,0 +1,290 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "World/PickupSnapshot.h"
+#include "HAL/PlatformFileManager.h"
+#include "Async/MappedFileHandle.h"
+
+namespace PickupSnapshot
+{
+	// Sections start on a 16 byte boundary so the mapped records can be read without unaligned access.
+	static int64 AlignOffset(const int64 Offset)
+	{
+		return Align(Offset, 16);
+	}
+
+	static bool WritePadding(IFileHandle* FileHandle, const int64 TargetOffset)
+	{
+		static const uint8 Zeros[16] = { 0 };
+		const int64 PaddingSize = TargetOffset - FileHandle->Tell();
+
+		return PaddingSize <= 0 || FileHandle->Write(Zeros, PaddingSize);
+	}
+
+	// Where the previous snapshot waits while a new one is moved into place.
+	static FString GetBackupFilename(const FString& Filename)
+	{
+		return Filename + TEXT(".bak");
+	}
+}
+
+FPickupSnapshotWriter::~FPickupSnapshotWriter()
+{
+	Cancel();
+}
+
+bool FPickupSnapshotWriter::Begin(const FString& InFilename, TArray<FPickupSnapshotRecord>&& InRecords, const TArray<FString>& ClassNames, const float ChunkSize)
+{
+	Cancel();
+
+	if (ChunkSize <= 0.f)
+		return false;
+
+	Filename = InFilename;
+	TempFilename = InFilename + TEXT(".tmp");
+	Records = MoveTemp(InRecords);
+	NumRecordsWritten = 0;
+
+	// Group records by chunk so each chunk is a contiguous run of the records section.
+	Records.Sort([ChunkSize](const FPickupSnapshotRecord& A, const FPickupSnapshotRecord& B)
+	{
+		const FIntPoint ChunkA = PickupSnapshot::GetChunkCoord(A.Location, ChunkSize);
+		const FIntPoint ChunkB = PickupSnapshot::GetChunkCoord(B.Location, ChunkSize);
+
+		return ChunkA.X != ChunkB.X ? ChunkA.X < ChunkB.X : ChunkA.Y < ChunkB.Y;
+	});
+
+	TArray<FPickupSnapshotChunk> Chunks;
+
+	for (int32 i = 0; i < Records.Num(); ++i)
+	{
+		const FIntPoint ChunkCoord = PickupSnapshot::GetChunkCoord(Records[i].Location, ChunkSize);
+
+		if (Chunks.Num() == 0 || Chunks.Last().X != ChunkCoord.X || Chunks.Last().Y != ChunkCoord.Y)
+		{
+			FPickupSnapshotChunk& Chunk = Chunks.AddDefaulted_GetRef();
+			Chunk.X = ChunkCoord.X;
+			Chunk.Y = ChunkCoord.Y;
+			Chunk.FirstRecord = i;
+			Chunk.NumRecords = 0;
+		}
+
+		Chunks.Last().NumRecords++;
+	}
+
+	TArray<FPickupSnapshotClass> Classes;
+	TArray<ANSICHAR> ClassNameBlob;
+
+	for (const FString& ClassName : ClassNames)
+	{
+		FPickupSnapshotClass& Class = Classes.AddDefaulted_GetRef();
+		Class.NameOffset = ClassNameBlob.Num();
+		Class.NameLength = ClassName.Len();
+
+		ClassNameBlob.Append(TCHAR_TO_ANSI(*ClassName), ClassName.Len());
+	}
+
+	FPickupSnapshotHeader Header;
+	Header.Magic = FPickupSnapshotHeader::SnapshotMagic;
+	Header.Version = FPickupSnapshotHeader::SnapshotVersion;
+	Header.NumClasses = Classes.Num();
+	Header.NumChunks = Chunks.Num();
+	Header.NumRecords = Records.Num();
+	Header.ChunkSize = ChunkSize;
+	Header.ClassesOffset = PickupSnapshot::AlignOffset(sizeof(FPickupSnapshotHeader));
+	Header.ClassNamesOffset = Header.ClassesOffset + Classes.Num() * sizeof(FPickupSnapshotClass);
+	Header.ChunksOffset = PickupSnapshot::AlignOffset(Header.ClassNamesOffset + ClassNameBlob.Num());
+	Header.RecordsOffset = PickupSnapshot::AlignOffset(Header.ChunksOffset + Chunks.Num() * sizeof(FPickupSnapshotChunk));
+
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	PlatformFile.CreateDirectoryTree(*FPaths::GetPath(Filename));
+
+	FileHandle = PlatformFile.OpenWrite(*TempFilename);
+
+	if (!FileHandle)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Couldn't open pickup snapshot %s for writing."), *TempFilename);
+		return false;
+	}
+
+	// Everything but the records is small, write it up front.
+	const bool bWroteTables = FileHandle->Write(reinterpret_cast<const uint8*>(&Header), sizeof(Header))
+		&& PickupSnapshot::WritePadding(FileHandle, Header.ClassesOffset)
+		&& FileHandle->Write(reinterpret_cast<const uint8*>(Classes.GetData()), Classes.Num() * sizeof(FPickupSnapshotClass))
+		&& FileHandle->Write(reinterpret_cast<const uint8*>(ClassNameBlob.GetData()), ClassNameBlob.Num())
+		&& PickupSnapshot::WritePadding(FileHandle, Header.ChunksOffset)
+		&& FileHandle->Write(reinterpret_cast<const uint8*>(Chunks.GetData()), Chunks.Num() * sizeof(FPickupSnapshotChunk))
+		&& PickupSnapshot::WritePadding(FileHandle, Header.RecordsOffset);
+
+	if (!bWroteTables)
+	{
+		Cancel();
+		return false;
+	}
+
+	return true;
+}
+
+bool FPickupSnapshotWriter::WriteRecords(const int32 MaxRecords)
+{
+	if (!FileHandle)
+		return false;
+
+	const int32 NumToWrite = FMath::Min(MaxRecords, Records.Num() - NumRecordsWritten);
+
+	if (NumToWrite > 0 && !FileHandle->Write(reinterpret_cast<const uint8*>(Records.GetData() + NumRecordsWritten), NumToWrite * sizeof(FPickupSnapshotRecord)))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Failed writing pickup snapshot %s."), *TempFilename);
+		Cancel();
+		return false;
+	}
+
+	NumRecordsWritten += NumToWrite;
+
+	if (NumRecordsWritten < Records.Num())
+		return false;
+
+	return Commit();
+}
+
+void FPickupSnapshotWriter::Cancel()
+{
+	if (!FileHandle)
+		return;
+
+	delete FileHandle;
+	FileHandle = nullptr;
+
+	FPlatformFileManager::Get().GetPlatformFile().DeleteFile(*TempFilename);
+	Records.Empty();
+}
+
+bool FPickupSnapshotWriter::Commit()
+{
+	delete FileHandle;
+	FileHandle = nullptr;
+	Records.Empty();
+
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	const FString BackupFilename = PickupSnapshot::GetBackupFilename(Filename);
+
+	// The previous snapshot is only deleted once the new one is in place, so a crash at any point leaves one of
+	// them for the reader. Without a current snapshot the backup is the only copy, so it is left alone.
+	if (PlatformFile.FileExists(*Filename))
+	{
+		PlatformFile.DeleteFile(*BackupFilename);
+
+		if (!PlatformFile.MoveFile(*BackupFilename, *Filename))
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Couldn't move pickup snapshot %s aside, keeping it."), *Filename);
+			PlatformFile.DeleteFile(*TempFilename);
+			return false;
+		}
+	}
+
+	if (!PlatformFile.MoveFile(*Filename, *TempFilename))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Couldn't move pickup snapshot %s into place."), *TempFilename);
+		PlatformFile.MoveFile(*Filename, *BackupFilename);
+		return false;
+	}
+
+	PlatformFile.DeleteFile(*BackupFilename);
+	return true;
+}
+
+FPickupSnapshotReader::~FPickupSnapshotReader()
+{
+	Close();
+}
+
+bool FPickupSnapshotReader::Open(const FString& Filename)
+{
+	Close();
+
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+
+	// A crash while the writer swapped files in leaves only the previous snapshot.
+	const FString BackupFilename = PickupSnapshot::GetBackupFilename(Filename);
+	const FString& OpenFilename = !PlatformFile.FileExists(*Filename) && PlatformFile.FileExists(*BackupFilename) ? BackupFilename : Filename;
+
+	MappedHandle = PlatformFile.OpenMapped(*OpenFilename);
+
+	if (!MappedHandle)
+		return false;
+
+	MappedRegion = MappedHandle->MapRegion();
+
+	if (!MappedRegion || MappedRegion->GetMappedSize() < (int64)sizeof(FPickupSnapshotHeader))
+	{
+		Close();
+		return false;
+	}
+
+	const uint8* Data = MappedRegion->GetMappedPtr();
+	const int64 Size = MappedRegion->GetMappedSize();
+
+	Header = reinterpret_cast<const FPickupSnapshotHeader*>(Data);
+
+	const bool bValidHeader = Header->Magic == FPickupSnapshotHeader::SnapshotMagic
+		&& Header->Version == FPickupSnapshotHeader::SnapshotVersion
+		&& Header->NumClasses >= 0 && Header->NumChunks >= 0 && Header->NumRecords >= 0
+		&& Header->ClassesOffset + Header->NumClasses * (int64)sizeof(FPickupSnapshotClass) <= Header->ClassNamesOffset
+		&& Header->ClassNamesOffset <= Header->ChunksOffset
+		&& Header->ChunksOffset + Header->NumChunks * (int64)sizeof(FPickupSnapshotChunk) <= Header->RecordsOffset
+		&& Header->RecordsOffset + Header->NumRecords * (int64)sizeof(FPickupSnapshotRecord) <= Size;
+
+	if (!bValidHeader)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Pickup snapshot %s is invalid or from an older version."), *Filename);
+		Close();
+		return false;
+	}
+
+	Classes = MakeArrayView(reinterpret_cast<const FPickupSnapshotClass*>(Data + Header->ClassesOffset), Header->NumClasses);
+	ClassNames = reinterpret_cast<const ANSICHAR*>(Data + Header->ClassNamesOffset);
+	ClassNamesSize = Header->ChunksOffset - Header->ClassNamesOffset;
+	Chunks = MakeArrayView(reinterpret_cast<const FPickupSnapshotChunk*>(Data + Header->ChunksOffset), Header->NumChunks);
+	Records = MakeArrayView(reinterpret_cast<const FPickupSnapshotRecord*>(Data + Header->RecordsOffset), Header->NumRecords);
+
+	for (const FPickupSnapshotChunk& Chunk : Chunks)
+	{
+		if (Chunk.FirstRecord < 0 || Chunk.NumRecords < 0 || Chunk.FirstRecord + Chunk.NumRecords > Records.Num())
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Pickup snapshot %s has a corrupt chunk table."), *Filename);
+			Close();
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void FPickupSnapshotReader::Close()
+{
+	delete MappedRegion;
+	MappedRegion = nullptr;
+
+	delete MappedHandle;
+	MappedHandle = nullptr;
+
+	Header = nullptr;
+	Classes = TArrayView<const FPickupSnapshotClass>();
+	ClassNames = nullptr;
+	ClassNamesSize = 0;
+	Chunks = TArrayView<const FPickupSnapshotChunk>();
+	Records = TArrayView<const FPickupSnapshotRecord>();
+}
+
+FString FPickupSnapshotReader::GetClassName(const int32 ClassIndex) const
+{
+	if (!Classes.IsValidIndex(ClassIndex))
+		return FString();
+
+	const FPickupSnapshotClass& Class = Classes[ClassIndex];
+
+	if (Class.NameOffset < 0 || Class.NameLength < 0 || Class.NameOffset + Class.NameLength > ClassNamesSize)
+		return FString();
+
+	return FString(Class.NameLength, ClassNames + Class.NameOffset);
+}
@@ -0,0 +1,132 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class IFileHandle;
+class IMappedFileHandle;
+class IMappedFileRegion;
+
+/**
+ * On disk layout of a world pickup snapshot. Every section is a flat array of fixed size records so the
+ * file can be memory mapped and read in place, no deserialization step.
+ *
+ * [Header][Classes][ClassNames][Chunks][Records]
+ *
+ * Records are grouped by spatial chunk, each chunk points at a contiguous run of records.
+ */
+struct FPickupSnapshotHeader
+{
+	static constexpr uint32 SnapshotMagic = 0x4E534B50; // 'PKSN'
+	static constexpr uint32 SnapshotVersion = 1;
+
+	uint32 Magic;
+	uint32 Version;
+	int32 NumClasses;
+	int32 NumChunks;
+	int32 NumRecords;
+	float ChunkSize;
+	int64 ClassesOffset;
+	int64 ClassNamesOffset;
+	int64 ChunksOffset;
+	int64 RecordsOffset;
+};
+
+// Item class path, stored as an ANSI string in the ClassNames blob.
+struct FPickupSnapshotClass
+{
+	int32 NameOffset;
+	int32 NameLength;
+};
+
+struct FPickupSnapshotChunk
+{
+	int32 X;
+	int32 Y;
+	int32 FirstRecord;
+	int32 NumRecords;
+};
+
+struct FPickupSnapshotRecord
+{
+	FVector3f Location;
+	FRotator3f Rotation;
+	int32 ClassIndex;
+	int32 Quantity;
+};
+
+static_assert(sizeof(FPickupSnapshotChunk) == 16, "Snapshot chunks are read in place, keep them tightly packed.");
+static_assert(sizeof(FPickupSnapshotRecord) == 32, "Snapshot records are read in place, keep them tightly packed.");
+
+/**
+ * Writes a snapshot a few records at a time so a large world can be saved without a frame spike.
+ * The file is written to a temp path and only moved over the previous snapshot once complete.
+ */
+class SURVIVALGAME_API FPickupSnapshotWriter
+{
+public:
+	~FPickupSnapshotWriter();
+
+	bool Begin(const FString& InFilename, TArray<FPickupSnapshotRecord>&& InRecords, const TArray<FString>& ClassNames, const float ChunkSize);
+
+	// Returns true once every record has been written and the snapshot committed.
+	bool WriteRecords(const int32 MaxRecords);
+
+	bool IsWriting() const { return FileHandle != nullptr; }
+
+	void Cancel();
+
+private:
+	bool Commit();
+
+	FString Filename;
+	FString TempFilename;
+
+	TArray<FPickupSnapshotRecord> Records;
+	int32 NumRecordsWritten = 0;
+
+	IFileHandle* FileHandle = nullptr;
+};
+
+/**
+ * Memory maps a snapshot and exposes its sections as views over the mapped file.
+ */
+class SURVIVALGAME_API FPickupSnapshotReader
+{
+public:
+	~FPickupSnapshotReader();
+
+	bool Open(const FString& Filename);
+	void Close();
+
+	bool IsOpen() const { return MappedRegion != nullptr; }
+
+	const FPickupSnapshotHeader& GetHeader() const { return *Header; }
+
+	TArrayView<const FPickupSnapshotChunk> GetChunks() const { return Chunks; }
+	TArrayView<const FPickupSnapshotRecord> GetRecords() const { return Records; }
+
+	TArrayView<const FPickupSnapshotRecord> GetChunkRecords(const FPickupSnapshotChunk& Chunk) const { return Records.Slice(Chunk.FirstRecord, Chunk.NumRecords); }
+
+	FString GetClassName(const int32 ClassIndex) const;
+
+private:
+	IMappedFileHandle* MappedHandle = nullptr;
+	IMappedFileRegion* MappedRegion = nullptr;
+
+	const FPickupSnapshotHeader* Header = nullptr;
+	TArrayView<const FPickupSnapshotClass> Classes;
+	const ANSICHAR* ClassNames = nullptr;
+	int64 ClassNamesSize = 0;
+	TArrayView<const FPickupSnapshotChunk> Chunks;
+	TArrayView<const FPickupSnapshotRecord> Records;
+};
+
+namespace PickupSnapshot
+{
+	FORCEINLINE FIntPoint GetChunkCoord(const FVector3f& Location, const float ChunkSize)
+	{
+		return FIntPoint(FMath::FloorToInt(Location.X / ChunkSize), FMath::FloorToInt(Location.Y / ChunkSize));
+	}
+}
@@ -0,0 +1,388 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "World/PickupSubsystem.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/Pawn.h"
+
+#include "World/Pickup.h"
+#include "Items/Item.h"
+
+UPickupSubsystem::UPickupSubsystem()
+	:CellSize(1000.f),
+	SnapshotInterval(300.f),
+	SnapshotChunkSize(10000.f),
+	SnapshotRecordsPerFrame(4096),
+	RestoreSpawnsPerFrame(200),
+	bRestoreSnapshotOnBeginPlay(true),
+	MergeRadius(150.f),
+	MergeBudgetMs(0.5f),
+	MergeQueueHead(0),
+	TimeSinceSnapshot(0.f),
+	RestoreChunk(0),
+	RestoreRecord(0)
+{
+}
+
+bool UPickupSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	if (!Super::ShouldCreateSubsystem(Outer))
+		return false;
+
+	const UWorld* World = Cast<UWorld>(Outer);
+	return World && (World->WorldType == EWorldType::Game || World->WorldType == EWorldType::PIE);
+}
+
+void UPickupSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	if (bRestoreSnapshotOnBeginPlay && InWorld.GetNetMode() != NM_Client)
+		RestoreSnapshot();
+}
+
+void UPickupSubsystem::Deinitialize()
+{
+	// Finish an in flight snapshot rather than lose it.
+	if (SnapshotWriter.IsWriting())
+		SnapshotWriter.WriteRecords(MAX_int32);
+
+	SnapshotReader.Close();
+
+	Pickups.Empty();
+	PickupIndices.Empty();
+	Cells.Empty();
+	PickupCells.Empty();
+	MergeQueue.Empty();
+
+	Super::Deinitialize();
+}
+
+void UPickupSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	if (GetWorld()->GetNetMode() == NM_Client)
+		return;
+
+	if (SnapshotReader.IsOpen())
+		TickRestore();
+
+	if (MergeRadius > 0.f)
+		TickMerge();
+
+	if (SnapshotWriter.IsWriting())
+	{
+		SnapshotWriter.WriteRecords(SnapshotRecordsPerFrame);
+	}
+	else if (SnapshotInterval > 0.f && !SnapshotReader.IsOpen())
+	{
+		TimeSinceSnapshot += DeltaTime;
+
+		if (TimeSinceSnapshot >= SnapshotInterval)
+			SaveSnapshot();
+	}
+}
+
+TStatId UPickupSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UPickupSubsystem, STATGROUP_Tickables);
+}
+
+void UPickupSubsystem::RegisterPickup(APickup* Pickup)
+{
+	if (!Pickup || PickupIndices.Contains(Pickup))
+		return;
+
+	const FIntPoint Cell = GetCell(Pickup->GetActorLocation());
+
+	PickupIndices.Add(Pickup, Pickups.Add(Pickup));
+	PickupCells.Add(Pickup, Cell);
+	Cells.FindOrAdd(Cell).Add(Pickup);
+
+	// Its item is set after spawning, so it is looked at next frame rather than now.
+	if (!Pickup->bNetStartup)
+		MergeQueue.Add(Pickup);
+}
+
+void UPickupSubsystem::UnregisterPickup(APickup* Pickup)
+{
+	int32 Index;
+
+	if (!PickupIndices.RemoveAndCopyValue(Pickup, Index))
+		return;
+
+	// Swap the last pickup into the hole so removal stays O(1).
+	Pickups.RemoveAtSwap(Index, 1, false);
+
+	if (Pickups.IsValidIndex(Index))
+		PickupIndices[Pickups[Index]] = Index;
+
+	FIntPoint Cell;
+	PickupCells.RemoveAndCopyValue(Pickup, Cell);
+
+	if (TArray<APickup*>* CellPickups = Cells.Find(Cell))
+	{
+		CellPickups->RemoveSingleSwap(Pickup, false);
+
+		if (CellPickups->Num() == 0)
+			Cells.Remove(Cell);
+	}
+}
+
+void UPickupSubsystem::ForEachPickupNear(const FVector& Location, const float Radius, TFunctionRef<void(APickup*)> Func) const
+{
+	const FIntPoint MinCell = GetCell(Location - FVector(Radius));
+	const FIntPoint MaxCell = GetCell(Location + FVector(Radius));
+
+	for (int32 X = MinCell.X; X <= MaxCell.X; ++X)
+	{
+		for (int32 Y = MinCell.Y; Y <= MaxCell.Y; ++Y)
+		{
+			if (const TArray<APickup*>* CellPickups = Cells.Find(FIntPoint(X, Y)))
+			{
+				for (APickup* Pickup : *CellPickups)
+				{
+					Func(Pickup);
+				}
+			}
+		}
+	}
+}
+
+void UPickupSubsystem::TickMerge()
+{
+	const double EndTime = FPlatformTime::Seconds() + MergeBudgetMs / 1000.0;
+
+	while (MergeQueueHead < MergeQueue.Num() && FPlatformTime::Seconds() < EndTime)
+	{
+		APickup* Pickup = MergeQueue[MergeQueueHead++].Get();
+
+		if (Pickup && CanMerge(Pickup))
+			MergeIntoNeighbours(Pickup);
+	}
+
+	if (MergeQueueHead >= MergeQueue.Num())
+	{
+		MergeQueue.Reset();
+		MergeQueueHead = 0;
+	}
+}
+
+void UPickupSubsystem::MergeIntoNeighbours(APickup* Pickup)
+{
+	UItem* Item = Pickup->GetItem();
+	const FVector Location = Pickup->GetActorLocation();
+	const float MergeRadiusSquared = FMath::Square(MergeRadius);
+
+	TArray<APickup*, TInlineAllocator<8>> Neighbours;
+
+	ForEachPickupNear(Location, MergeRadius, [&](APickup* Other)
+	{
+		if (Other != Pickup && CanMerge(Other) && Other->GetItem()->GetClass() == Item->GetClass()
+			&& FVector::DistSquared(Location, Other->GetActorLocation()) <= MergeRadiusSquared)
+		{
+			Neighbours.Add(Other);
+		}
+	});
+
+	// Fill the biggest stacks first so we end up with as few pickups as possible.
+	Neighbours.Sort([](const APickup& A, const APickup& B)
+	{
+		return A.GetItem()->GetQuantity() > B.GetItem()->GetQuantity();
+	});
+
+	for (APickup* Neighbour : Neighbours)
+	{
+		UItem* NeighbourItem = Neighbour->GetItem();
+		const int32 MoveAmount = FMath::Min(Item->GetQuantity(), NeighbourItem->MaxStackSize - NeighbourItem->GetQuantity());
+
+		if (MoveAmount <= 0)
+			continue;
+
+		NeighbourItem->SetQuantity(NeighbourItem->GetQuantity() + MoveAmount);
+		Item->SetQuantity(Item->GetQuantity() - MoveAmount);
+
+		if (Item->GetQuantity() <= 0)
+		{
+			Pickup->Destroy();
+			return;
+		}
+	}
+}
+
+bool UPickupSubsystem::CanMerge(const APickup* Pickup)
+{
+	const UItem* Item = Pickup->GetItem();
+
+	return !Pickup->bNetStartup && !Pickup->IsPendingKillPending() && Item && Item->bIsStackable && Item->GetQuantity() < Item->MaxStackSize;
+}
+
+FIntPoint UPickupSubsystem::GetCell(const FVector& Location) const
+{
+	return FIntPoint(FMath::FloorToInt(Location.X / CellSize), FMath::FloorToInt(Location.Y / CellSize));
+}
+
+bool UPickupSubsystem::SaveSnapshot()
+{
+	if (GetWorld()->GetNetMode() == NM_Client || SnapshotWriter.IsWriting())
+		return false;
+
+	TimeSinceSnapshot = 0.f;
+
+	TArray<FPickupSnapshotRecord> Records;
+	Records.Reserve(Pickups.Num());
+
+	TArray<FString> ClassNames;
+	TMap<UClass*, int32> ClassIndices;
+
+	for (APickup* Pickup : Pickups)
+	{
+		// Map placed pickups come back with the level, only dropped pickups need saving.
+		if (!Pickup || Pickup->bNetStartup || Pickup->IsPendingKillPending() || !Pickup->GetItem())
+			continue;
+
+		UItem* Item = Pickup->GetItem();
+		int32* ClassIndex = ClassIndices.Find(Item->GetClass());
+
+		if (!ClassIndex)
+		{
+			ClassIndex = &ClassIndices.Add(Item->GetClass(), ClassNames.Num());
+			ClassNames.Add(Item->GetClass()->GetPathName());
+		}
+
+		FPickupSnapshotRecord& Record = Records.AddDefaulted_GetRef();
+		Record.Location = FVector3f(Pickup->GetActorLocation());
+		Record.Rotation = FRotator3f(Pickup->GetActorRotation());
+		Record.ClassIndex = *ClassIndex;
+		Record.Quantity = Item->GetQuantity();
+	}
+
+	return SnapshotWriter.Begin(GetSnapshotFilename(), MoveTemp(Records), ClassNames, SnapshotChunkSize);
+}
+
+bool UPickupSubsystem::RestoreSnapshot()
+{
+	if (GetWorld()->GetNetMode() == NM_Client || SnapshotReader.IsOpen())
+		return false;
+
+	if (!SnapshotReader.Open(GetSnapshotFilename()))
+		return false;
+
+	const FPickupSnapshotHeader& Header = SnapshotReader.GetHeader();
+
+	// Resolve each class once up front, records only carry an index.
+	RestoreItemClasses.SetNum(Header.NumClasses);
+
+	for (int32 i = 0; i < Header.NumClasses; ++i)
+	{
+		RestoreItemClasses[i] = FSoftClassPath(SnapshotReader.GetClassName(i)).TryLoadClass<UItem>();
+	}
+
+	TArray<FVector> PlayerLocations;
+
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		if (APawn* Pawn = It->Get() ? It->Get()->GetPawn() : nullptr)
+			PlayerLocations.Add(Pawn->GetActorLocation());
+	}
+
+	TArrayView<const FPickupSnapshotChunk> Chunks = SnapshotReader.GetChunks();
+
+	RestoreChunkOrder.SetNum(Chunks.Num());
+
+	for (int32 i = 0; i < Chunks.Num(); ++i)
+	{
+		RestoreChunkOrder[i] = i;
+	}
+
+	// Nobody is connected on a fresh boot, in that case chunks are simply restored in file order.
+	if (PlayerLocations.Num() > 0)
+	{
+		const float ChunkSize = Header.ChunkSize;
+
+		auto ChunkDistSquared = [&](const FPickupSnapshotChunk& Chunk)
+		{
+			const FVector ChunkCenter((Chunk.X + 0.5f) * ChunkSize, (Chunk.Y + 0.5f) * ChunkSize, 0.f);
+			float MinDistSquared = MAX_flt;
+
+			for (const FVector& PlayerLocation : PlayerLocations)
+			{
+				MinDistSquared = FMath::Min(MinDistSquared, (float)FVector::DistSquaredXY(ChunkCenter, PlayerLocation));
+			}
+
+			return MinDistSquared;
+		};
+
+		RestoreChunkOrder.Sort([&](const int32 A, const int32 B)
+		{
+			return ChunkDistSquared(Chunks[A]) < ChunkDistSquared(Chunks[B]);
+		});
+	}
+
+	RestoreChunk = 0;
+	RestoreRecord = 0;
+
+	UE_LOG(LogTemp, Log, TEXT("Restoring %i pickups in %i chunks from %s."), Header.NumRecords, Header.NumChunks, *GetSnapshotFilename());
+
+	return true;
+}
+
+void UPickupSubsystem::TickRestore()
+{
+	UClass* FallbackPickupClass = DefaultPickupClass.LoadSynchronous();
+	TArrayView<const FPickupSnapshotChunk> Chunks = SnapshotReader.GetChunks();
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+	int32 NumSpawned = 0;
+
+	while (RestoreChunk < RestoreChunkOrder.Num() && NumSpawned < RestoreSpawnsPerFrame)
+	{
+		TArrayView<const FPickupSnapshotRecord> Records = SnapshotReader.GetChunkRecords(Chunks[RestoreChunkOrder[RestoreChunk]]);
+
+		for (; RestoreRecord < Records.Num() && NumSpawned < RestoreSpawnsPerFrame; ++RestoreRecord)
+		{
+			const FPickupSnapshotRecord& Record = Records[RestoreRecord];
+			UClass* ItemClass = RestoreItemClasses.IsValidIndex(Record.ClassIndex) ? RestoreItemClasses[Record.ClassIndex] : nullptr;
+
+			if (!ItemClass)
+				continue;
+
+			UClass* PickupClass = ItemClass->GetDefaultObject<UItem>()->PickupClass;
+
+			if (!PickupClass)
+				PickupClass = FallbackPickupClass;
+
+			if (!PickupClass)
+				continue;
+
+			const FTransform SpawnTransform(FRotator(Record.Rotation), FVector(Record.Location));
+
+			if (APickup* Pickup = GetWorld()->SpawnActor<APickup>(PickupClass, SpawnTransform, SpawnParams))
+				Pickup->InitPickup(ItemClass, Record.Quantity);
+
+			++NumSpawned;
+		}
+
+		if (RestoreRecord >= Records.Num())
+		{
+			++RestoreChunk;
+			RestoreRecord = 0;
+		}
+	}
+
+	if (RestoreChunk >= RestoreChunkOrder.Num())
+	{
+		SnapshotReader.Close();
+		RestoreItemClasses.Empty();
+		RestoreChunkOrder.Empty();
+	}
+}
+
+FString UPickupSubsystem::GetSnapshotFilename() const
+{
+	return FPaths::ProjectSavedDir() / TEXT("PickupSnapshots") / UWorld::RemovePIEPrefix(GetWorld()->GetMapName()) + TEXT(".bin");
+}
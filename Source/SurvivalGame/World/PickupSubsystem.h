@@ -0,0 +1,120 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "World/PickupSnapshot.h"
+#include "PickupSubsystem.generated.h"
+
+/**
+ * Server side registry of every pickup in the world. Keeps a coarse spatial grid of pickups and owns
+ * saving them to, and streaming them back from, a memory mapped snapshot so dropped items survive a restart.
+ */
+UCLASS(Config = Game)
+class SURVIVALGAME_API UPickupSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	UPickupSubsystem();
+
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Deinitialize() override;
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	void RegisterPickup(class APickup* Pickup);
+	void UnregisterPickup(class APickup* Pickup);
+
+	FORCEINLINE const TArray<class APickup*>& GetPickups() const { return Pickups; }
+
+	// Calls Func for every registered pickup in the grid cells overlapping the radius. Callers do their own exact distance test.
+	void ForEachPickupNear(const FVector& Location, const float Radius, TFunctionRef<void(class APickup*)> Func) const;
+
+	/* Snapshot */
+	UFUNCTION(BlueprintCallable, Category = "Pickups")
+	bool SaveSnapshot();
+
+	UFUNCTION(BlueprintCallable, Category = "Pickups")
+	bool RestoreSnapshot();
+
+	UFUNCTION(BlueprintPure, Category = "Pickups")
+	FORCEINLINE bool IsRestoringSnapshot() const { return SnapshotReader.IsOpen(); }
+
+	FString GetSnapshotFilename() const;
+	/* Snapshot */
+
+protected:
+
+	// Size of a spatial grid cell, should be a bit larger than the biggest radius anything queries with.
+	UPROPERTY(Config)
+	float CellSize;
+
+	// Seconds between automatic snapshots, 0 disables them.
+	UPROPERTY(Config)
+	float SnapshotInterval;
+
+	// Size of the chunks pickups are grouped by in the snapshot and streamed back in with.
+	UPROPERTY(Config)
+	float SnapshotChunkSize;
+
+	UPROPERTY(Config)
+	int32 SnapshotRecordsPerFrame;
+
+	UPROPERTY(Config)
+	int32 RestoreSpawnsPerFrame;
+
+	UPROPERTY(Config)
+	bool bRestoreSnapshotOnBeginPlay;
+
+	// Spawned for restored items that don't specify a PickupClass.
+	UPROPERTY(Config)
+	TSoftClassPtr<class APickup> DefaultPickupClass;
+
+	// Dropped pickups of the same class closer than this are merged into one stack.
+	UPROPERTY(Config)
+	float MergeRadius;
+
+	UPROPERTY(Config)
+	float MergeBudgetMs;
+
+private:
+
+	FIntPoint GetCell(const FVector& Location) const;
+
+	void TickRestore();
+
+	void TickMerge();
+
+	// Tops up nearby stacks of the same class from Pickup, destroying it if that empties it.
+	void MergeIntoNeighbours(class APickup* Pickup);
+
+	static bool CanMerge(const class APickup* Pickup);
+
+	TArray<class APickup*> Pickups;
+	TMap<class APickup*, int32> PickupIndices;
+	TMap<FIntPoint, TArray<class APickup*>> Cells;
+
+	// The cell each pickup was filed under, it may have moved since.
+	TMap<class APickup*, FIntPoint> PickupCells;
+
+	// Pickups waiting to be checked for neighbours to merge with.
+	TArray<TWeakObjectPtr<class APickup>> MergeQueue;
+	int32 MergeQueueHead;
+
+	FPickupSnapshotWriter SnapshotWriter;
+	float TimeSinceSnapshot;
+
+	FPickupSnapshotReader SnapshotReader;
+
+	UPROPERTY()
+	TArray<UClass*> RestoreItemClasses;
+
+	// Chunks left to restore, closest to a player first.
+	TArray<int32> RestoreChunkOrder;
+	int32 RestoreChunk;
+	int32 RestoreRecord;
+};
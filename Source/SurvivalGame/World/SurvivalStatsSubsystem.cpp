@@ -0,0 +1,204 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "World/SurvivalStatsSubsystem.h"
+#include "Engine/World.h"
+
+#include "Player/SurvivalCharacter.h"
+
+USurvivalStatsSubsystem::USurvivalStatsSubsystem()
+	:FixedStep(0.1f),
+	MaxStepsPerTick(5),
+	ReplicationInterval(1.f),
+	MaxHealth(100.f),
+	MaxHunger(100.f),
+	MaxThirst(100.f),
+	MaxStamina(100.f),
+	HungerDecayPerSecond(0.05f),
+	ThirstDecayPerSecond(0.08f),
+	StaminaRegenPerSecond(10.f),
+	HealthRegenPerSecond(0.5f),
+	WellFedFraction(0.5f),
+	DeprivationDamagePerSecond(1.f),
+	StepAccumulator(0.f),
+	TimeSinceReplication(0.f)
+{
+}
+
+bool USurvivalStatsSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	if (!Super::ShouldCreateSubsystem(Outer))
+		return false;
+
+	const UWorld* World = Cast<UWorld>(Outer);
+	return World && (World->WorldType == EWorldType::Game || World->WorldType == EWorldType::PIE);
+}
+
+void USurvivalStatsSubsystem::Deinitialize()
+{
+	Characters.Empty();
+	CharacterIndices.Empty();
+
+	for (int32 StatIndex = 0; StatIndex < FQuantizedSurvivalStats::NumStats; ++StatIndex)
+	{
+		Stats[StatIndex].Empty();
+		PendingEffects[StatIndex].Empty();
+	}
+
+	Super::Deinitialize();
+}
+
+void USurvivalStatsSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	if (Characters.Num() == 0 || FixedStep <= 0.f)
+		return;
+
+	StepAccumulator = FMath::Min(StepAccumulator + DeltaTime, FixedStep * MaxStepsPerTick);
+
+	while (StepAccumulator >= FixedStep)
+	{
+		Step(FixedStep);
+		StepAccumulator -= FixedStep;
+	}
+
+	TimeSinceReplication += DeltaTime;
+
+	if (TimeSinceReplication >= ReplicationInterval)
+	{
+		ReplicateStats();
+		TimeSinceReplication = 0.f;
+	}
+}
+
+TStatId USurvivalStatsSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(USurvivalStatsSubsystem, STATGROUP_Tickables);
+}
+
+void USurvivalStatsSubsystem::RegisterCharacter(ASurvivalCharacter* Character)
+{
+	if (!Character || CharacterIndices.Contains(Character))
+		return;
+
+	CharacterIndices.Add(Character, Characters.Add(Character));
+
+	for (int32 StatIndex = 0; StatIndex < FQuantizedSurvivalStats::NumStats; ++StatIndex)
+	{
+		Stats[StatIndex].Add(GetMaxValue((ESurvivalStat)StatIndex));
+		PendingEffects[StatIndex].Add(0.f);
+	}
+
+	Character->SetSurvivalStats(FQuantizedSurvivalStats());
+}
+
+void USurvivalStatsSubsystem::UnregisterCharacter(ASurvivalCharacter* Character)
+{
+	int32 Index;
+
+	if (!CharacterIndices.RemoveAndCopyValue(Character, Index))
+		return;
+
+	// Swap the last character into the hole so every array stays packed.
+	Characters.RemoveAtSwap(Index, 1, false);
+
+	for (int32 StatIndex = 0; StatIndex < FQuantizedSurvivalStats::NumStats; ++StatIndex)
+	{
+		Stats[StatIndex].RemoveAtSwap(Index, 1, false);
+		PendingEffects[StatIndex].RemoveAtSwap(Index, 1, false);
+	}
+
+	if (Characters.IsValidIndex(Index))
+		CharacterIndices[Characters[Index]] = Index;
+}
+
+void USurvivalStatsSubsystem::ApplyEffect(const ASurvivalCharacter* Character, const ESurvivalStat Stat, const float Amount)
+{
+	const int32* Index = CharacterIndices.Find(Character);
+
+	if (Index && Stat < ESurvivalStat::SS_MAX)
+		PendingEffects[(int32)Stat][*Index] += Amount;
+}
+
+float USurvivalStatsSubsystem::GetStat(const ASurvivalCharacter* Character, const ESurvivalStat Stat) const
+{
+	const int32* Index = CharacterIndices.Find(Character);
+	return Index && Stat < ESurvivalStat::SS_MAX ? Stats[(int32)Stat][*Index] : 0.f;
+}
+
+float USurvivalStatsSubsystem::GetMaxValue(const ESurvivalStat Stat) const
+{
+	switch (Stat)
+	{
+	case ESurvivalStat::SS_Health:
+		return MaxHealth;
+	case ESurvivalStat::SS_Hunger:
+		return MaxHunger;
+	case ESurvivalStat::SS_Thirst:
+		return MaxThirst;
+	case ESurvivalStat::SS_Stamina:
+		return MaxStamina;
+	default:
+		return 0.f;
+	}
+}
+
+void USurvivalStatsSubsystem::Step(const float DeltaTime)
+{
+	const int32 NumCharacters = Characters.Num();
+
+	float* RESTRICT Health = Stats[(int32)ESurvivalStat::SS_Health].GetData();
+	float* RESTRICT Hunger = Stats[(int32)ESurvivalStat::SS_Hunger].GetData();
+	float* RESTRICT Thirst = Stats[(int32)ESurvivalStat::SS_Thirst].GetData();
+	float* RESTRICT Stamina = Stats[(int32)ESurvivalStat::SS_Stamina].GetData();
+
+	const float* RESTRICT HealthEffects = PendingEffects[(int32)ESurvivalStat::SS_Health].GetData();
+	const float* RESTRICT HungerEffects = PendingEffects[(int32)ESurvivalStat::SS_Hunger].GetData();
+	const float* RESTRICT ThirstEffects = PendingEffects[(int32)ESurvivalStat::SS_Thirst].GetData();
+	const float* RESTRICT StaminaEffects = PendingEffects[(int32)ESurvivalStat::SS_Stamina].GetData();
+
+	const float HungerDecay = HungerDecayPerSecond * DeltaTime;
+	const float ThirstDecay = ThirstDecayPerSecond * DeltaTime;
+	const float StaminaRegen = StaminaRegenPerSecond * DeltaTime;
+	const float HealthRegen = HealthRegenPerSecond * DeltaTime;
+	const float DeprivationDamage = DeprivationDamagePerSecond * DeltaTime;
+	const float WellFedHunger = WellFedFraction * MaxHunger;
+	const float WellFedThirst = WellFedFraction * MaxThirst;
+
+	// No branches or calls in here beyond selects and min/max, so the compiler can vectorize it.
+	for (int32 i = 0; i < NumCharacters; ++i)
+	{
+		const float NewHunger = FMath::Clamp(Hunger[i] + HungerEffects[i] - HungerDecay, 0.f, MaxHunger);
+		const float NewThirst = FMath::Clamp(Thirst[i] + ThirstEffects[i] - ThirstDecay, 0.f, MaxThirst);
+
+		const float WellFed = ((NewHunger >= WellFedHunger) & (NewThirst >= WellFedThirst)) ? 1.f : 0.f;
+		const float Deprivation = (NewHunger <= 0.f ? 1.f : 0.f) + (NewThirst <= 0.f ? 1.f : 0.f);
+
+		Health[i] = FMath::Clamp(Health[i] + HealthEffects[i] + WellFed * HealthRegen - Deprivation * DeprivationDamage, 0.f, MaxHealth);
+		Hunger[i] = NewHunger;
+		Thirst[i] = NewThirst;
+		Stamina[i] = FMath::Clamp(Stamina[i] + StaminaEffects[i] + StaminaRegen, 0.f, MaxStamina);
+	}
+
+	for (int32 StatIndex = 0; StatIndex < FQuantizedSurvivalStats::NumStats; ++StatIndex)
+	{
+		FMemory::Memzero(PendingEffects[StatIndex].GetData(), NumCharacters * sizeof(float));
+	}
+}
+
+void USurvivalStatsSubsystem::ReplicateStats()
+{
+	for (int32 i = 0; i < Characters.Num(); ++i)
+	{
+		FQuantizedSurvivalStats Quantized;
+
+		for (int32 StatIndex = 0; StatIndex < FQuantizedSurvivalStats::NumStats; ++StatIndex)
+		{
+			const float MaxValue = GetMaxValue((ESurvivalStat)StatIndex);
+			Quantized.Values[StatIndex] = MaxValue > 0.f ? (uint8)FMath::RoundToInt(Stats[StatIndex][i] / MaxValue * 255.f) : 0;
+		}
+
+		Characters[i]->SetSurvivalStats(Quantized);
+	}
+}
@@ -0,0 +1,153 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "SurvivalStatsSubsystem.generated.h"
+
+UENUM(BlueprintType)
+enum class ESurvivalStat : uint8
+{
+	SS_Health UMETA(DisplayName = "Health"),
+	SS_Hunger UMETA(DisplayName = "Hunger"),
+	SS_Thirst UMETA(DisplayName = "Thirst"),
+	SS_Stamina UMETA(DisplayName = "Stamina"),
+	SS_MAX UMETA(Hidden)
+};
+
+// What the owning client gets of its survival stats, each one quantized to a byte of its maximum.
+USTRUCT()
+struct FQuantizedSurvivalStats
+{
+	GENERATED_BODY()
+
+public:
+	static constexpr int32 NumStats = (int32)ESurvivalStat::SS_MAX;
+
+	FQuantizedSurvivalStats()
+	{
+		FMemory::Memset(Values, 0xFF, sizeof(Values));
+	}
+
+	uint8 Values[NumStats];
+
+	bool operator==(const FQuantizedSurvivalStats& Other) const
+	{
+		return FMemory::Memcmp(Values, Other.Values, sizeof(Values)) == 0;
+	}
+
+	bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess)
+	{
+		Ar.Serialize(Values, sizeof(Values));
+		bOutSuccess = true;
+		return true;
+	}
+};
+
+template<>
+struct TStructOpsTypeTraits<FQuantizedSurvivalStats> : public TStructOpsTypeTraitsBase2<FQuantizedSurvivalStats>
+{
+	enum
+	{
+		WithNetSerializer = true,
+		WithIdenticalViaEquality = true
+	};
+};
+
+/**
+ * Server side survival stats for every player. Each stat is one contiguous array across all characters, stepped at a
+ * fixed rate in a single branchless pass instead of a tick per character. Owners get a quantized copy at
+ * ReplicationInterval, which is plenty for UI.
+ */
+UCLASS(Config = Game)
+class SURVIVALGAME_API USurvivalStatsSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	USurvivalStatsSubsystem();
+
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Deinitialize() override;
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	/* Server */
+	void RegisterCharacter(class ASurvivalCharacter* Character);
+	void UnregisterCharacter(class ASurvivalCharacter* Character);
+
+	// Added to the stat on the next step, along with the decay and regen for that step.
+	void ApplyEffect(const class ASurvivalCharacter* Character, const ESurvivalStat Stat, const float Amount);
+
+	// 0 for characters that aren't registered.
+	float GetStat(const class ASurvivalCharacter* Character, const ESurvivalStat Stat) const;
+	/* Server */
+
+	// Reads config, so clients can call it on the class default to dequantize.
+	float GetMaxValue(const ESurvivalStat Stat) const;
+
+protected:
+
+	// Seconds simulated per step.
+	UPROPERTY(Config)
+	float FixedStep;
+
+	// Steps a slow frame can catch up on, anything beyond is dropped.
+	UPROPERTY(Config)
+	int32 MaxStepsPerTick;
+
+	UPROPERTY(Config)
+	float ReplicationInterval;
+
+	UPROPERTY(Config)
+	float MaxHealth;
+
+	UPROPERTY(Config)
+	float MaxHunger;
+
+	UPROPERTY(Config)
+	float MaxThirst;
+
+	UPROPERTY(Config)
+	float MaxStamina;
+
+	UPROPERTY(Config)
+	float HungerDecayPerSecond;
+
+	UPROPERTY(Config)
+	float ThirstDecayPerSecond;
+
+	UPROPERTY(Config)
+	float StaminaRegenPerSecond;
+
+	// Only while hunger and thirst are both at or above WellFedFraction of their maximum.
+	UPROPERTY(Config)
+	float HealthRegenPerSecond;
+
+	UPROPERTY(Config)
+	float WellFedFraction;
+
+	// For each of hunger and thirst that has run out.
+	UPROPERTY(Config)
+	float DeprivationDamagePerSecond;
+
+private:
+
+	void Step(const float DeltaTime);
+
+	void ReplicateStats();
+
+	TArray<class ASurvivalCharacter*> Characters;
+	TMap<class ASurvivalCharacter*, int32> CharacterIndices;
+
+	// One array per stat, index i of each belongs to Characters[i].
+	TArray<float> Stats[FQuantizedSurvivalStats::NumStats];
+
+	// Effects waiting for the next step, laid out like Stats.
+	TArray<float> PendingEffects[FQuantizedSurvivalStats::NumStats];
+
+	float StepAccumulator;
+	float TimeSinceReplication;
+};